@@ -0,0 +1,723 @@
+// Сравнение производительности Vector и std::vector.
+// Сборка: g++ -std=c++17 -O2 -DNDEBUG benchmark.cpp -lbenchmark -lpthread -o benchmark
+// Помимо времени на операцию выводятся счётчики allocs (число выделений памяти),
+// alloc_bytes (выделено байт) и moved_bytes (байт, перенесённых конструкторами копирования
+// и перемещения; для тривиальных типов перенос через memcpy не учитывается)
+#include "bit_vector.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_map.h"
+#include "huge_page_allocator.h"
+#include "incremental_vector.h"
+#include "pmr_vector.h"
+#include "soa_vector.h"
+#include "vector.h"
+#include "vector_io.h"
+#include "vector_simd.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    size_t num_allocations = 0;
+    size_t num_allocated_bytes = 0;
+    size_t num_moved_bytes = 0;
+    // Позволяет не учитывать подготовку данных, выполняемую вне замера
+    bool counting_enabled = true;
+
+    // Аллокатор, через который оба контейнера получают память, чтобы учитывать её одинаково
+    template <typename T>
+    struct BenchAllocator {
+        using value_type = T;
+
+        BenchAllocator() noexcept = default;
+        template <typename U>
+        BenchAllocator(const BenchAllocator<U>&) noexcept {
+        }
+
+        T* allocate(size_t n) {
+            if (counting_enabled) {
+                ++num_allocations;
+                num_allocated_bytes += n * sizeof(T);
+            }
+            return std::allocator<T>().allocate(n);
+        }
+        void deallocate(T* p, size_t n) noexcept {
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        bool operator==(const BenchAllocator&) const noexcept {
+            return true;
+        }
+        bool operator!=(const BenchAllocator&) const noexcept {
+            return false;
+        }
+    };
+
+    template <typename T>
+    using StdVector = std::vector<T, BenchAllocator<T>>;
+    template <typename T>
+    using BenchVector = Vector<T, BenchAllocator<T>>;
+    template <typename T>
+    using IncrementalBenchVector = IncrementalVector<T, BenchAllocator<T>>;
+
+    // Тривиально копируемый элемент заданного размера
+    template <size_t Size>
+    struct Pod {
+        Pod() = default;
+        explicit Pod(int value) noexcept {
+            data[0] = static_cast<unsigned char>(value);
+        }
+        unsigned char data[Size];
+    };
+
+    // Элемент с пользовательскими конструкторами, считающий перенесённые байты.
+    // NoexceptMove = false заставляет контейнеры копировать элементы при реаллокации
+    template <size_t Size, bool NoexceptMove>
+    struct Tracked {
+        Tracked() = default;
+        explicit Tracked(int value) noexcept {
+            data[0] = static_cast<unsigned char>(value);
+        }
+        Tracked(const Tracked& other) noexcept {
+            CopyFrom(other);
+        }
+        Tracked(Tracked&& other) noexcept(NoexceptMove) {
+            CopyFrom(other);
+        }
+        Tracked& operator=(const Tracked& other) noexcept {
+            CopyFrom(other);
+            return *this;
+        }
+        Tracked& operator=(Tracked&& other) noexcept(NoexceptMove) {
+            CopyFrom(other);
+            return *this;
+        }
+        ~Tracked() {
+            benchmark::DoNotOptimize(data[0]);
+        }
+        void CopyFrom(const Tracked& other) noexcept {
+            std::memcpy(data, other.data, Size);
+            if (counting_enabled) {
+                num_moved_bytes += Size;
+            }
+        }
+
+        unsigned char data[Size] = {};
+    };
+
+    using TrackedNoexcept = Tracked<16, true>;
+    using TrackedThrowing = Tracked<16, false>;
+
+    template <typename T>
+    T MakeValue() {
+        return T(1);
+    }
+    template <>
+    std::string MakeValue<std::string>() {
+        return std::string(32, 'x');
+    }
+
+    // Единый интерфейс к std::vector и Vector
+    template <typename T>
+    void PushBack(StdVector<T>& v, const T& value) {
+        v.push_back(value);
+    }
+    template <typename T>
+    void PushBack(BenchVector<T>& v, const T& value) {
+        v.PushBack(value);
+    }
+
+    template <typename T>
+    void PushBack(IncrementalBenchVector<T>& v, const T& value) {
+        v.PushBack(value);
+    }
+
+    template <typename T>
+    void EmplaceBack(StdVector<T>& v, int value) {
+        v.emplace_back(value);
+    }
+    template <typename T>
+    void EmplaceBack(BenchVector<T>& v, int value) {
+        v.EmplaceBack(value);
+    }
+
+    template <typename T>
+    void InsertAt(StdVector<T>& v, size_t pos, const T& value) {
+        v.insert(v.begin() + pos, value);
+    }
+    template <typename T>
+    void InsertAt(BenchVector<T>& v, size_t pos, const T& value) {
+        v.Insert(v.cbegin() + pos, value);
+    }
+
+    template <typename T>
+    void EraseAt(StdVector<T>& v, size_t pos) {
+        v.erase(v.begin() + pos);
+    }
+    template <typename T>
+    void EraseAt(BenchVector<T>& v, size_t pos) {
+        v.Erase(v.cbegin() + pos);
+    }
+
+    template <typename T>
+    void Reserve(StdVector<T>& v, size_t n) {
+        v.reserve(n);
+    }
+    template <typename T>
+    void Reserve(BenchVector<T>& v, size_t n) {
+        v.Reserve(n);
+    }
+
+    template <typename T>
+    size_t Size(const StdVector<T>& v) {
+        return v.size();
+    }
+    template <typename T>
+    size_t Size(const BenchVector<T>& v) {
+        return v.Size();
+    }
+
+    void ResetCounters() {
+        num_allocations = 0;
+        num_allocated_bytes = 0;
+        num_moved_bytes = 0;
+    }
+
+    // Переводит накопленные за все итерации счётчики в значения на одну итерацию
+    void ReportCounters(benchmark::State& state, size_t ops_per_iteration) {
+        using benchmark::Counter;
+        const double iterations = static_cast<double>(state.iterations());
+        state.counters["allocs"] = Counter(static_cast<double>(num_allocations) / iterations);
+        state.counters["alloc_bytes"] = Counter(static_cast<double>(num_allocated_bytes) / iterations);
+        state.counters["moved_bytes"] = Counter(static_cast<double>(num_moved_bytes) / iterations);
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ops_per_iteration));
+    }
+
+    template <typename Container>
+    void BM_PushBack(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>();
+        ResetCounters();
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < n; ++i) {
+                PushBack(v, value);
+            }
+            benchmark::DoNotOptimize(&v);
+        }
+        ReportCounters(state, n);
+    }
+
+    template <typename Container>
+    void BM_EmplaceBack(benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        ResetCounters();
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < n; ++i) {
+                EmplaceBack(v, static_cast<int>(i));
+            }
+            benchmark::DoNotOptimize(&v);
+        }
+        ReportCounters(state, n);
+    }
+
+    template <typename Container>
+    void BM_ReservePushBack(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>();
+        ResetCounters();
+        for (auto _ : state) {
+            Container v;
+            Reserve(v, n);
+            for (size_t i = 0; i < n; ++i) {
+                PushBack(v, value);
+            }
+            benchmark::DoNotOptimize(&v);
+        }
+        ReportCounters(state, n);
+    }
+
+    // Вставка в середину n элементов в изначально пустой контейнер
+    template <typename Container>
+    void BM_InsertMiddle(benchmark::State& state) {
+        using T = typename Container::value_type;
+        const size_t n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>();
+        ResetCounters();
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < n; ++i) {
+                InsertAt(v, Size(v) / 2, value);
+            }
+            benchmark::DoNotOptimize(&v);
+        }
+        ReportCounters(state, n);
+    }
+
+    // Удаление всех элементов по одному из середины
+    template <typename Container>
+    void BM_EraseMiddle(benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        ResetCounters();
+        for (auto _ : state) {
+            state.PauseTiming();
+            counting_enabled = false;
+            Container v(n);
+            counting_enabled = true;
+            state.ResumeTiming();
+            while (Size(v) > 0) {
+                EraseAt(v, Size(v) / 2);
+            }
+            benchmark::DoNotOptimize(&v);
+        }
+        ReportCounters(state, n);
+    }
+
+    template <typename Container>
+    void BM_Copy(benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        counting_enabled = false;
+        const Container src(n);
+        counting_enabled = true;
+        ResetCounters();
+        for (auto _ : state) {
+            Container copy(src);
+            benchmark::DoNotOptimize(&copy);
+        }
+        ReportCounters(state, n);
+    }
+
+    template <typename Container>
+    void BM_CopyAssign(benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        counting_enabled = false;
+        const Container src(n);
+        Container dst(n / 2);
+        counting_enabled = true;
+        ResetCounters();
+        for (auto _ : state) {
+            dst = src;
+            benchmark::DoNotOptimize(&dst);
+        }
+        ReportCounters(state, n);
+    }
+
+    // Худшая задержка одного PushBack: у Vector она определяется переносом всех элементов
+    // при реаллокации, у IncrementalVector — переносом одной порции
+    template <typename Container>
+    void BM_PushBackMaxLatency(benchmark::State& state) {
+        using T = typename Container::value_type;
+        using Clock = std::chrono::steady_clock;
+        const size_t n = static_cast<size_t>(state.range(0));
+        const T value = MakeValue<T>();
+        Clock::duration max_latency{};
+        ResetCounters();
+        for (auto _ : state) {
+            Container v;
+            for (size_t i = 0; i < n; ++i) {
+                const auto start = Clock::now();
+                PushBack(v, value);
+                max_latency = std::max(max_latency, Clock::now() - start);
+            }
+            benchmark::DoNotOptimize(&v);
+        }
+        ReportCounters(state, n);
+        state.counters["max_push_ns"] = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(max_latency).count());
+    }
+
+    // Случайные чтения из большого вектора: время определяется промахами TLB и кешей
+    template <typename Container>
+    void BM_RandomGather(benchmark::State& state) {
+        const size_t n = static_cast<size_t>(state.range(0));
+        const Container v(n);
+        constexpr size_t kReads = 1'000'000;
+        uint64_t seed = 1;
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < kReads; ++i) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                sum += v[static_cast<size_t>(seed >> 33) % n];
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kReads));
+    }
+
+    // Запрос создаёт много небольших векторов и освобождает их в конце: operator delete
+    // для каждого вектора против одного Reset() арены
+    void BM_RequestVectorsHeap(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            Vector<Vector<int>> vectors;
+            vectors.Reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                vectors.EmplaceBack(i % 64 + 1);
+            }
+            benchmark::DoNotOptimize(vectors.begin());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_RequestVectorsArena(benchmark::State& state) {
+        const size_t count = static_cast<size_t>(state.range(0));
+        MonotonicArena arena;
+        for (auto _ : state) {
+            {
+                pmr::Vector<pmr::Vector<int>> vectors(&arena);
+                vectors.Reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    vectors.EmplaceBack(i % 64 + 1);
+                }
+                benchmark::DoNotOptimize(vectors.begin());
+            }
+            arena.Reset();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // Сумма одного поля записи: массив структур против столбца SoAVector
+    struct Record {
+        int64_t id;
+        double price;
+        double weight;
+        int64_t flags[5];
+    };
+
+    void BM_FieldScanAoS(benchmark::State& state) {
+        Vector<Record> records(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            double sum = 0;
+            for (const Record& record : records) {
+                sum += record.price;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_FieldScanSoA(benchmark::State& state) {
+        using Flags = std::array<int64_t, 5>;
+        SoAVector<int64_t, double, double, Flags> records(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            double sum = 0;
+            for (double price : records.Column<1>()) {
+                sum += price;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // Сохранение и загрузка через поток: поэлементно против WriteTo/ReadFrom
+    void BM_StreamRoundTripElementwise(benchmark::State& state) {
+        Vector<int64_t> v(static_cast<size_t>(state.range(0)), 1);
+        std::stringstream stream;
+        for (auto _ : state) {
+            stream.seekp(0);
+            stream.seekg(0);
+            const size_t size = v.Size();
+            stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            for (const int64_t& x : v) {
+                stream.write(reinterpret_cast<const char*>(&x), sizeof(x));
+            }
+            Vector<int64_t> copy;
+            size_t copy_size = 0;
+            stream.read(reinterpret_cast<char*>(&copy_size), sizeof(copy_size));
+            copy.Reserve(copy_size);
+            for (size_t i = 0; i < copy_size; ++i) {
+                int64_t x;
+                stream.read(reinterpret_cast<char*>(&x), sizeof(x));
+                copy.PushBack(x);
+            }
+            benchmark::DoNotOptimize(copy.begin());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(int64_t)));
+    }
+
+    void BM_StreamRoundTripBulk(benchmark::State& state) {
+        Vector<int64_t> v(static_cast<size_t>(state.range(0)), 1);
+        std::stringstream stream;
+        for (auto _ : state) {
+            stream.seekp(0);
+            stream.seekg(0);
+            WriteTo(stream, v);
+            Vector<int64_t> copy;
+            ReadFrom(stream, copy);
+            benchmark::DoNotOptimize(copy.begin());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(int64_t)));
+    }
+
+    // Публикация снимка таблицы: глубокая копия Vector против разделяемой копии CowVector
+    template <typename Container>
+    void BM_Snapshot(benchmark::State& state) {
+        const Container table(static_cast<size_t>(state.range(0)), 1);
+        for (auto _ : state) {
+            Container snapshot(table);
+            benchmark::DoNotOptimize(snapshot.cbegin());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Поиск в таблице int -> int: дерево std::map против отсортированных векторов
+    template <typename Table>
+    void BM_TableLookup(benchmark::State& state) {
+        const int size = static_cast<int>(state.range(0));
+        Table table;
+        for (int i = 0; i < size; ++i) {
+            table[i * 2] = i;
+        }
+        uint32_t seed = 1;
+        for (auto _ : state) {
+            seed = seed * 1664525u + 1013904223u;
+            const int key = static_cast<int>(seed % static_cast<uint32_t>(2 * size));
+            benchmark::DoNotOptimize(table.find(key));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <typename SearchPolicy>
+    struct FlatLookupTable {
+        FlatMap<int, int, std::less<int>, std::allocator<int>, std::allocator<int>, SearchPolicy> map;
+
+        int& operator[](int key) {
+            return map[key];
+        }
+
+        const int* find(int key) const {
+            return map.Find(key);
+        }
+    };
+
+    // Подсчёт установленных флагов: байт на флаг против бита на флаг
+    void BM_CountFlagsBytes(benchmark::State& state) {
+        Vector<uint8_t> flags(static_cast<size_t>(state.range(0)));
+        for (size_t i = 0; i < flags.Size(); i += 3) {
+            flags[i] = 1;
+        }
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::count(flags.begin(), flags.end(), uint8_t{ 1 }));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_CountFlagsBits(benchmark::State& state) {
+        BitVector<> flags(static_cast<size_t>(state.range(0)));
+        for (size_t i = 0; i < flags.Size(); i += 3) {
+            flags.Set(i);
+        }
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(flags.Count());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // Цена проверок: суммирование по индексам и проход итераторами при разных CheckPolicy
+    template <typename CheckPolicy>
+    using CheckedInts = Vector<int64_t, std::allocator<int64_t>, DoublingGrowth, NoVectorStats, CheckPolicy>;
+
+    template <typename CheckPolicy>
+    void BM_IndexSum(benchmark::State& state) {
+        const CheckedInts<CheckPolicy> v(static_cast<size_t>(state.range(0)), int64_t{ 1 });
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < v.Size(); ++i) {
+                sum += v[i];
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template <typename CheckPolicy>
+    void BM_IteratorSum(benchmark::State& state) {
+        const CheckedInts<CheckPolicy> v(static_cast<size_t>(state.range(0)), int64_t{ 1 });
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (const int64_t value : v) {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // Копирование большого вектора в одном потоке и в нескольких
+    template <typename T>
+    void BM_CopyLarge(benchmark::State& state) {
+        const Vector<T> v(static_cast<size_t>(state.range(0)), T(1));
+        for (auto _ : state) {
+            Vector<T> copy(v);
+            benchmark::DoNotOptimize(copy.begin());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(T)));
+    }
+
+    template <typename T>
+    void BM_ParallelCopyLarge(benchmark::State& state) {
+        const Vector<T> v(static_cast<size_t>(state.range(0)), T(1));
+        for (auto _ : state) {
+            Vector<T> copy(parallel, v);
+            benchmark::DoNotOptimize(copy.begin());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(T)));
+    }
+
+    // Сумма и подсчёт элементов: std::accumulate/std::count против векторных ядер
+    template <typename T>
+    void BM_StdSum(benchmark::State& state) {
+        const AlignedVector<T> v(static_cast<size_t>(state.range(0)), T(1));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), T{}));
+            benchmark::DoNotOptimize(std::count(v.begin(), v.end(), T(2)));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(2 * sizeof(T)));
+    }
+
+    template <typename T>
+    void BM_SimdSum(benchmark::State& state) {
+        const AlignedVector<T> v(static_cast<size_t>(state.range(0)), T(1));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(simd::Sum(v));
+            benchmark::DoNotOptimize(simd::Count(v, T(2)));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(2 * sizeof(T)));
+    }
+
+    // Одновременное добавление из нескольких потоков в общий контейнер
+    template <typename Container>
+    struct SharedAppend;
+
+    // Базовый вариант: Vector, защищённый мьютексом
+    template <typename T>
+    struct SharedAppend<Vector<T>> {
+        void Append(const T& value) {
+            std::lock_guard guard(mutex);
+            vector.PushBack(value);
+        }
+
+        std::mutex mutex;
+        Vector<T> vector;
+    };
+
+    template <typename T>
+    struct SharedAppend<ConcurrentVector<T>> {
+        void Append(const T& value) {
+            vector.PushBack(value);
+        }
+
+        ConcurrentVector<T> vector;
+    };
+
+    constexpr size_t kConcurrentBatch = 1'000;
+
+    template <typename Container>
+    void BM_ConcurrentPushBack(benchmark::State& state) {
+        static SharedAppend<Container>* shared = nullptr;
+        if (state.thread_index() == 0) {
+            shared = new SharedAppend<Container>();
+        }
+        for (auto _ : state) {
+            for (size_t i = 0; i < kConcurrentBatch; ++i) {
+                shared->Append(static_cast<int>(i));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kConcurrentBatch));
+        if (state.thread_index() == 0) {
+            delete shared;
+        }
+    }
+
+    constexpr int64_t kMinSize = 10;
+    constexpr int64_t kMaxSize = 100'000'000;
+    constexpr int64_t kMaxMiddleSize = 10'000;
+    constexpr int64_t kMaxTrackedSize = 1'000'000;
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(func, type, max_size)                                                   \
+    BENCHMARK_TEMPLATE(func, StdVector<type>)->RangeMultiplier(10)->Range(kMinSize, max_size); \
+    BENCHMARK_TEMPLATE(func, BenchVector<type>)->RangeMultiplier(10)->Range(kMinSize, max_size)
+
+#define VECTOR_BENCHMARK_ALL_TYPES(func, max_size)                  \
+    VECTOR_BENCHMARK(func, int, max_size);                          \
+    VECTOR_BENCHMARK(func, Pod<64>, max_size / 10);                 \
+    VECTOR_BENCHMARK(func, Pod<256>, max_size / 100);               \
+    VECTOR_BENCHMARK(func, std::string, kMaxTrackedSize);           \
+    VECTOR_BENCHMARK(func, TrackedNoexcept, kMaxTrackedSize);       \
+    VECTOR_BENCHMARK(func, TrackedThrowing, kMaxTrackedSize)
+
+VECTOR_BENCHMARK_ALL_TYPES(BM_PushBack, kMaxSize);
+VECTOR_BENCHMARK_ALL_TYPES(BM_ReservePushBack, kMaxSize);
+VECTOR_BENCHMARK_ALL_TYPES(BM_Copy, kMaxSize);
+VECTOR_BENCHMARK_ALL_TYPES(BM_CopyAssign, kMaxSize);
+VECTOR_BENCHMARK_ALL_TYPES(BM_InsertMiddle, kMaxMiddleSize);
+VECTOR_BENCHMARK_ALL_TYPES(BM_EraseMiddle, kMaxMiddleSize);
+
+VECTOR_BENCHMARK(BM_EmplaceBack, int, kMaxSize);
+VECTOR_BENCHMARK(BM_EmplaceBack, TrackedNoexcept, kMaxTrackedSize);
+VECTOR_BENCHMARK(BM_EmplaceBack, TrackedThrowing, kMaxTrackedSize);
+
+BENCHMARK_TEMPLATE(BM_PushBackMaxLatency, BenchVector<std::string>)->RangeMultiplier(10)->Range(kMinSize, kMaxTrackedSize);
+BENCHMARK_TEMPLATE(BM_PushBackMaxLatency, IncrementalBenchVector<std::string>)
+    ->RangeMultiplier(10)
+    ->Range(kMinSize, kMaxTrackedSize);
+
+BENCHMARK_TEMPLATE(BM_RandomGather, Vector<int>)->RangeMultiplier(8)->Range(1 << 16, 1 << 25);
+BENCHMARK_TEMPLATE(BM_RandomGather, Vector<int, HugePageAllocator<int>>)->RangeMultiplier(8)->Range(1 << 16, 1 << 25);
+
+BENCHMARK(BM_RequestVectorsHeap)->RangeMultiplier(8)->Range(64, 1 << 15);
+BENCHMARK(BM_RequestVectorsArena)->RangeMultiplier(8)->Range(64, 1 << 15);
+
+BENCHMARK(BM_FieldScanAoS)->RangeMultiplier(16)->Range(1 << 12, 1 << 22);
+BENCHMARK(BM_FieldScanSoA)->RangeMultiplier(16)->Range(1 << 12, 1 << 22);
+
+BENCHMARK(BM_StreamRoundTripElementwise)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_StreamRoundTripBulk)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_Snapshot, Vector<int64_t>)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Snapshot, CowVector<int64_t>)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_TableLookup, std::map<int, int>)->RangeMultiplier(16)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_TableLookup, FlatLookupTable<BranchlessSearch>)->RangeMultiplier(16)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_TableLookup, FlatLookupTable<EytzingerSearch>)->RangeMultiplier(16)->Range(1 << 6, 1 << 20);
+
+BENCHMARK(BM_CountFlagsBytes)->RangeMultiplier(16)->Range(1 << 12, 1 << 26);
+BENCHMARK(BM_CountFlagsBits)->RangeMultiplier(16)->Range(1 << 12, 1 << 26);
+
+BENCHMARK_TEMPLATE(BM_IndexSum, NoVectorChecks)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexSum, HardenedVectorChecks)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexSum, CheckedVectorIterators)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_IteratorSum, NoVectorChecks)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_IteratorSum, HardenedVectorChecks)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_IteratorSum, CheckedVectorIterators)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_CopyLarge, int64_t)->RangeMultiplier(16)->Range(1 << 16, 1 << 26)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelCopyLarge, int64_t)->RangeMultiplier(16)->Range(1 << 16, 1 << 26)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_StdSum, float)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_SimdSum, float)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_StdSum, int32_t)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_SimdSum, int32_t)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+// Число итераций ограничено, чтобы общий контейнер не разрастался без меры
+BENCHMARK_TEMPLATE(BM_ConcurrentPushBack, Vector<int>)->ThreadRange(1, 32)->Iterations(1'000)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentPushBack, ConcurrentVector<int>)->ThreadRange(1, 32)->Iterations(1'000)->UseRealTime();
+
+BENCHMARK_MAIN();
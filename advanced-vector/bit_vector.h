@@ -0,0 +1,521 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+
+namespace detail {
+
+inline unsigned PopCount64(uint64_t word) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+    unsigned count = 0;
+    for (; word != 0; word &= word - 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned CountTrailingZeros64(uint64_t word) noexcept {
+    assert(word != 0);
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned count = 0;
+    for (; (word & 1) == 0; word >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Наименьший беззнаковый тип, вмещающий Bits бит
+template <size_t Bits>
+using PackedValue = std::conditional_t<
+    Bits <= 8, uint8_t,
+    std::conditional_t<Bits <= 16, uint16_t, std::conditional_t<Bits <= 32, uint32_t, uint64_t>>>;
+
+}  // namespace detail
+
+// Вектор бит, упакованных по 64 в слово: в 8 раз компактнее Vector<bool> из байтов.
+// Слова хранятся в Vector<uint64_t>, поэтому рост и аллокатор те же, что у Vector.
+// Биты последнего слова за пределами Size() всегда нулевые, так что Count, FindNext
+// и сравнение работают целыми словами
+template <typename Allocator = std::allocator<uint64_t>>
+class BitVector {
+public:
+    using Word = uint64_t;
+    using allocator_type = Allocator;
+
+    static constexpr size_t kWordBits = 64;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Ссылка на бит, которую возвращает неконстантный operator[]
+    class Reference {
+    public:
+        operator bool() const noexcept {
+            return (*word_ & mask_) != 0;
+        }
+
+        Reference& operator=(bool value) noexcept {
+            if (value) {
+                *word_ |= mask_;
+            }
+            else {
+                *word_ &= ~mask_;
+            }
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) noexcept {
+            return *this = static_cast<bool>(other);
+        }
+
+        void Flip() noexcept {
+            *word_ ^= mask_;
+        }
+
+    private:
+        friend class BitVector;
+
+        Reference(Word* word, Word mask) noexcept
+            : word_(word)
+            , mask_(mask) {
+        }
+
+        Word* word_;
+        Word mask_;
+    };
+
+    BitVector() = default;
+
+    explicit BitVector(const Allocator& alloc) noexcept
+        : words_(alloc) {
+    }
+
+    explicit BitVector(size_t size, bool value = false, const Allocator& alloc = Allocator())
+        : words_(alloc) {
+        Resize(size, value);
+    }
+
+    BitVector(std::initializer_list<bool> values, const Allocator& alloc = Allocator())
+        : words_(alloc) {
+        Reserve(values.size());
+        for (bool value : values) {
+            PushBack(value);
+        }
+    }
+
+    void Swap(BitVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return words_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * kWordBits;
+    }
+
+    void Reserve(size_t new_capacity) {
+        words_.Reserve(WordsFor(new_capacity));
+    }
+
+    void Resize(size_t new_size, bool value = false) {
+        const size_t old_size = size_;
+        words_.Resize(WordsFor(new_size));
+        size_ = new_size;
+        if (new_size < old_size) {
+            ClearTail();
+        }
+        else if (value) {
+            SetRange(old_size, new_size);
+        }
+    }
+
+    void Clear() noexcept {
+        words_.Clear();
+        size_ = 0;
+    }
+
+    void PushBack(bool value) {
+        if (size_ % kWordBits == 0) {
+            words_.PushBack(0);
+        }
+        if (value) {
+            words_[size_ / kWordBits] |= Mask(size_);
+        }
+        ++size_;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        if (size_ % kWordBits == 0) {
+            words_.PopBack();
+        }
+        else {
+            words_[size_ / kWordBits] &= ~Mask(size_);
+        }
+    }
+
+    bool operator[](size_t index) const noexcept {
+        return Test(index);
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Reference(&words_[index / kWordBits], Mask(index));
+    }
+
+    bool Test(size_t index) const noexcept {
+        assert(index < size_);
+        return (words_[index / kWordBits] & Mask(index)) != 0;
+    }
+
+    void Set(size_t index, bool value = true) noexcept {
+        (*this)[index] = value;
+    }
+
+    void Reset(size_t index) noexcept {
+        Set(index, false);
+    }
+
+    void Flip(size_t index) noexcept {
+        (*this)[index].Flip();
+    }
+
+    // Инвертирует все биты
+    void Flip() noexcept {
+        for (Word& word : words_) {
+            word = ~word;
+        }
+        ClearTail();
+    }
+
+    // Число установленных бит
+    size_t Count() const noexcept {
+        size_t count = 0;
+        for (Word word : words_) {
+            count += detail::PopCount64(word);
+        }
+        return count;
+    }
+
+    bool Any() const noexcept {
+        return std::any_of(words_.begin(), words_.end(), [](Word word) { return word != 0; });
+    }
+
+    bool None() const noexcept {
+        return !Any();
+    }
+
+    size_t FindFirst() const noexcept {
+        return FindNext(0);
+    }
+
+    // Индекс первого установленного бита не меньше pos или npos
+    size_t FindNext(size_t pos) const noexcept {
+        if (pos >= size_) {
+            return npos;
+        }
+        size_t index = pos / kWordBits;
+        Word word = words_[index] & (~Word{ 0 } << (pos % kWordBits));
+        while (word == 0) {
+            if (++index == words_.Size()) {
+                return npos;
+            }
+            word = words_[index];
+        }
+        return index * kWordBits + detail::CountTrailingZeros64(word);
+    }
+
+    // Вызывает action(index) для каждого установленного бита по возрастанию индексов
+    template <typename Action>
+    void ForEachSet(Action action) const {
+        for (size_t index = 0; index < words_.Size(); ++index) {
+            for (Word word = words_[index]; word != 0; word &= word - 1) {
+                action(index * kWordBits + detail::CountTrailingZeros64(word));
+            }
+        }
+    }
+
+    // Побитовые операции над векторами одного размера
+    BitVector& operator&=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](Word lhs, Word rhs) { return lhs & rhs; });
+    }
+
+    BitVector& operator|=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](Word lhs, Word rhs) { return lhs | rhs; });
+    }
+
+    BitVector& operator^=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](Word lhs, Word rhs) { return lhs ^ rhs; });
+    }
+
+    // Слова с битами: бит i лежит в слове i / 64 на позиции i % 64
+    VectorView<const Word> Words() const noexcept {
+        return words_.View();
+    }
+
+    bool operator==(const BitVector& rhs) const noexcept {
+        return size_ == rhs.size_ && std::equal(words_.begin(), words_.end(), rhs.words_.begin());
+    }
+
+    bool operator!=(const BitVector& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+private:
+    static size_t WordsFor(size_t bits) noexcept {
+        return bits / kWordBits + (bits % kWordBits != 0);
+    }
+
+    static Word Mask(size_t index) noexcept {
+        return Word{ 1 } << (index % kWordBits);
+    }
+
+    // Устанавливает биты [first, last) целыми словами, кроме крайних
+    void SetRange(size_t first, size_t last) noexcept {
+        for (; first < last && first % kWordBits != 0; ++first) {
+            words_[first / kWordBits] |= Mask(first);
+        }
+        for (; last - first >= kWordBits; first += kWordBits) {
+            words_[first / kWordBits] = ~Word{ 0 };
+        }
+        for (; first < last; ++first) {
+            words_[first / kWordBits] |= Mask(first);
+        }
+    }
+
+    void ClearTail() noexcept {
+        if (size_ % kWordBits != 0) {
+            words_[size_ / kWordBits] &= Mask(size_) - 1;
+        }
+    }
+
+    template <typename Op>
+    BitVector& Combine(const BitVector& rhs, Op op) noexcept {
+        assert(size_ == rhs.size_);
+        Word* words = words_.begin();
+        const Word* rhs_words = rhs.words_.begin();
+        for (size_t i = 0, count = words_.Size(); i < count; ++i) {
+            words[i] = op(words[i], rhs_words[i]);
+        }
+        return *this;
+    }
+
+    Vector<Word, Allocator> words_;
+    size_t size_ = 0;
+};
+
+// Вектор беззнаковых целых по Bits бит. Значения не пересекают границ 64-битных слов:
+// в слово помещается 64 / Bits значений, поэтому чтение и запись касаются одного слова,
+// а при Bits, не делящем 64, старшие биты слова не используются
+template <size_t Bits, typename Allocator = std::allocator<uint64_t>>
+class PackedIntVector {
+    static_assert(Bits > 0 && Bits <= 64, "PackedIntVector supports 1 to 64 bits per value");
+
+public:
+    using Word = uint64_t;
+    using value_type = detail::PackedValue<Bits>;
+    using allocator_type = Allocator;
+
+    static constexpr size_t kBits = Bits;
+    static constexpr size_t kValuesPerWord = 64 / Bits;
+    static constexpr Word kMask = Bits == 64 ? ~Word{ 0 } : (Word{ 1 } << Bits) - 1;
+    static constexpr value_type kMaxValue = static_cast<value_type>(kMask);
+
+    // Ссылка на значение, которую возвращает неконстантный operator[]
+    class Reference {
+    public:
+        operator value_type() const noexcept {
+            return static_cast<value_type>((*word_ >> shift_) & kMask);
+        }
+
+        Reference& operator=(value_type value) noexcept {
+            assert(value <= kMaxValue);
+            *word_ = (*word_ & ~(kMask << shift_)) | (static_cast<Word>(value) << shift_);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) noexcept {
+            return *this = static_cast<value_type>(other);
+        }
+
+    private:
+        friend class PackedIntVector;
+
+        Reference(Word* word, unsigned shift) noexcept
+            : word_(word)
+            , shift_(shift) {
+        }
+
+        Word* word_;
+        unsigned shift_;
+    };
+
+    PackedIntVector() = default;
+
+    explicit PackedIntVector(const Allocator& alloc) noexcept
+        : words_(alloc) {
+    }
+
+    explicit PackedIntVector(size_t size, value_type value = 0, const Allocator& alloc = Allocator())
+        : words_(alloc) {
+        Resize(size, value);
+    }
+
+    PackedIntVector(std::initializer_list<value_type> values, const Allocator& alloc = Allocator())
+        : words_(alloc) {
+        Reserve(values.size());
+        for (value_type value : values) {
+            PushBack(value);
+        }
+    }
+
+    void Swap(PackedIntVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return words_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * kValuesPerWord;
+    }
+
+    void Reserve(size_t new_capacity) {
+        words_.Reserve(WordsFor(new_capacity));
+    }
+
+    // Полные слова новых значений заполняются одним образцом
+    void Resize(size_t new_size, value_type value = 0) {
+        assert(value <= kMaxValue);
+        const size_t old_size = size_;
+        words_.Resize(WordsFor(new_size));
+        size_ = new_size;
+        if (new_size < old_size) {
+            ClearTail();
+            return;
+        }
+        if (value == 0) {
+            return;
+        }
+        size_t index = old_size;
+        for (; index < new_size && index % kValuesPerWord != 0; ++index) {
+            Set(index, value);
+        }
+        const Word pattern = Pattern(value);
+        for (; new_size - index >= kValuesPerWord; index += kValuesPerWord) {
+            words_[index / kValuesPerWord] = pattern;
+        }
+        for (; index < new_size; ++index) {
+            Set(index, value);
+        }
+    }
+
+    void Clear() noexcept {
+        words_.Clear();
+        size_ = 0;
+    }
+
+    void PushBack(value_type value) {
+        assert(value <= kMaxValue);
+        if (size_ % kValuesPerWord == 0) {
+            words_.PushBack(0);
+        }
+        words_[size_ / kValuesPerWord] |= static_cast<Word>(value) << Shift(size_);
+        ++size_;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        if (size_ % kValuesPerWord == 0) {
+            words_.PopBack();
+        }
+        else {
+            words_[size_ / kValuesPerWord] &= ~(kMask << Shift(size_));
+        }
+    }
+
+    value_type operator[](size_t index) const noexcept {
+        return Get(index);
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Reference(&words_[index / kValuesPerWord], Shift(index));
+    }
+
+    value_type Get(size_t index) const noexcept {
+        assert(index < size_);
+        return static_cast<value_type>((words_[index / kValuesPerWord] >> Shift(index)) & kMask);
+    }
+
+    void Set(size_t index, value_type value) noexcept {
+        (*this)[index] = value;
+    }
+
+    // Значения упакованы от младших бит слова к старшим; неиспользуемые биты нулевые
+    VectorView<const Word> Words() const noexcept {
+        return words_.View();
+    }
+
+    bool operator==(const PackedIntVector& rhs) const noexcept {
+        return size_ == rhs.size_ && std::equal(words_.begin(), words_.end(), rhs.words_.begin());
+    }
+
+    bool operator!=(const PackedIntVector& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+private:
+    static size_t WordsFor(size_t count) noexcept {
+        return count / kValuesPerWord + (count % kValuesPerWord != 0);
+    }
+
+    static unsigned Shift(size_t index) noexcept {
+        return static_cast<unsigned>(index % kValuesPerWord * Bits);
+    }
+
+    static Word Pattern(value_type value) noexcept {
+        Word pattern = 0;
+        for (size_t i = 0; i < kValuesPerWord; ++i) {
+            pattern |= static_cast<Word>(value) << (i * Bits);
+        }
+        return pattern;
+    }
+
+    void ClearTail() noexcept {
+        if (size_ % kValuesPerWord != 0) {
+            const unsigned used_bits = Shift(size_);
+            words_[size_ / kValuesPerWord] &= (Word{ 1 } << used_bits) - 1;
+        }
+    }
+
+    Vector<Word, Allocator> words_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include "segmented_vector.h"
+#include "vector.h"
+
+#include <array>
+#include <atomic>
+
+// Вектор, допускающий одновременное добавление элементов из нескольких потоков без блокировок.
+// Память выделяется сегментами, размеры которых растут как степени двойки: сегмент s вмещает
+// FirstSegmentSize << s элементов. Элементы никогда не перемещаются, поэтому ссылки на них
+// остаются действительными до Freeze, Clear или разрушения вектора.
+// Чтение элемента, добавленного другим потоком, допустимо только после синхронизации с ним
+// (например, после join). Freeze, Clear и деструктор не должны выполняться одновременно с EmplaceBack.
+// Под ASan свободные ячейки не размечаются: потоки заполняют один сегмент одновременно и не по порядку,
+// а разметка ASan описывает только непрерывный префикс и не атомарна
+template <typename T, typename Allocator = std::allocator<T>, size_t FirstSegmentSize = 32>
+class ConcurrentVector : private Allocator {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Layout = detail::SegmentLayout<FirstSegmentSize>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : Allocator(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+    }
+
+    // Резервирует индекс и конструирует элемент в своём сегменте. Индекс занимается только
+    // после того, как его сегмент выделен, поэтому при нехватке памяти вектор не меняется.
+    // Если конструирование из args может выбросить исключение, объект сначала создаётся
+    // во временной переменной, чтобы зарезервированная ячейка не осталась пустой
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            T* place = ReserveSlot();
+            AllocTraits::construct(GetAlloc(), place, std::forward<Args>(args)...);
+            return *place;
+        }
+        else {
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "ConcurrentVector requires nothrow construction from args or nothrow move");
+            T value(std::forward<Args>(args)...);
+            return EmplaceBack(std::move(value));
+        }
+    }
+
+    T& PushBack(const T& value) {
+        return EmplaceBack(value);
+    }
+
+    T& PushBack(T&& value) {
+        return EmplaceBack(std::move(value));
+    }
+
+    // Число зарезервированных ячеек. Пока добавление не завершено, часть из них может быть не создана
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        const size_t segment = Layout::SegmentOf(index);
+        T* data = segments_[segment].load(std::memory_order_acquire);
+        assert(data != nullptr);
+        return data[index - Layout::SegmentBegin(segment)];
+    }
+
+    // Переносит элементы в непрерывный Vector, оставляя текущий вектор пустым
+    Vector<T, Allocator> Freeze() {
+        Vector<T, Allocator> result(GetAlloc());
+        const size_t size = Size();
+        result.Reserve(size);
+        ForEachSegment(size, [&result](T* data, size_t count) {
+            result.AppendRange(std::make_move_iterator(data), std::make_move_iterator(data + count));
+        });
+        Clear();
+        return result;
+    }
+
+    // Разрушает элементы и освобождает все сегменты
+    void Clear() noexcept {
+        ForEachSegment(Size(), [this](T* data, size_t count) {
+            detail::DestroyN(GetAlloc(), data, count);
+        });
+        for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+            T* data = segments_[segment].exchange(nullptr, std::memory_order_relaxed);
+            if (data != nullptr) {
+                AllocTraits::deallocate(GetAlloc(), data, Layout::SegmentSize(segment));
+            }
+        }
+        size_.store(0, std::memory_order_release);
+    }
+
+    Allocator& GetAllocator() noexcept {
+        return GetAlloc();
+    }
+
+private:
+    static constexpr size_t kMaxSegments = Layout::kMaxSegments;
+    // Размер и массив сегментов лежат в разных кеш-линиях, чтобы инкремент размера
+    // не вытеснял из кешей других потоков указатели на сегменты
+    static constexpr size_t kCacheLineSize = 64;
+
+    Allocator& GetAlloc() noexcept {
+        return static_cast<Allocator&>(*this);
+    }
+
+    // Занимает следующий индекс и возвращает адрес его ячейки. Сегмент индекса выделяется
+    // до того, как размер увеличивается, поэтому каждая учтённая в Size() ячейка лежит
+    // в существующем сегменте. Если выделить сегмент не удалось, исключение выходит наружу,
+    // сегмент остаётся пустым, и следующее добавление попробует выделить его снова
+    T* ReserveSlot() {
+        size_t index = size_.load(std::memory_order_relaxed);
+        T* data = nullptr;
+        do {
+            const size_t segment = Layout::SegmentOf(index);
+            data = segments_[segment].load(std::memory_order_acquire);
+            if (data == nullptr) {
+                data = AllocateSegment(segment);
+            }
+        } while (!size_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+        return data + (index - Layout::SegmentBegin(Layout::SegmentOf(index)));
+    }
+
+    // Из нескольких потоков, одновременно выделивших один сегмент, его устанавливает первый,
+    // остальные освобождают свой буфер
+    T* AllocateSegment(size_t segment) {
+        T* expected = nullptr;
+        T* data = AllocTraits::allocate(GetAlloc(), Layout::SegmentSize(segment));
+        if (segments_[segment].compare_exchange_strong(expected, data, std::memory_order_acq_rel)) {
+            return data;
+        }
+        AllocTraits::deallocate(GetAlloc(), data, Layout::SegmentSize(segment));
+        return expected;
+    }
+
+    // Вызывает action(data, count) для созданных элементов каждого сегмента в порядке индексов
+    template <typename Action>
+    void ForEachSegment(size_t size, Action action) {
+        for (size_t segment = 0; segment < kMaxSegments && Layout::SegmentBegin(segment) < size; ++segment) {
+            T* data = segments_[segment].load(std::memory_order_acquire);
+            if (data != nullptr) {
+                action(data, std::min(Layout::SegmentSize(segment), size - Layout::SegmentBegin(segment)));
+            }
+        }
+    }
+
+    alignas(kCacheLineSize) std::atomic<size_t> size_ = 0;
+    alignas(kCacheLineSize) std::array<std::atomic<T*>, kMaxSegments> segments_ = {};
+};
@@ -0,0 +1,297 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Вектор с копированием при записи. Копии разделяют один буфер с атомарным счётчиком ссылок,
+// поэтому копирование выполняется за O(1), а элементы копируются один раз — при первом изменении
+// разделяемого вектора. Чтение через константные методы никогда не копирует элементы.
+// Разные объекты, разделяющие буфер, можно использовать из разных потоков одновременно
+// (как копии std::shared_ptr), один объект — нет.
+// Неконстантные operator[], begin(), end(), EmplaceBack и Mutable() возвращают ссылки на элементы,
+// через которые буфер можно изменить и после копирования, поэтому такой буфер перестаёт
+// разделяться: следующие копии делаются глубокими. Set и PushBack ссылок не возвращают
+template <typename T, typename Allocator = std::allocator<T>>
+class CowVector : private Allocator {
+    using Data = Vector<T, Allocator>;
+
+    struct Block {
+        template <typename... Args>
+        explicit Block(Args&&... args)
+            : data(std::forward<Args>(args)...) {
+        }
+
+        std::atomic<size_t> refs = 1;
+        // Изменяется только единственным владельцем блока
+        bool shareable = true;
+        Data data;
+    };
+
+    using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+    using BlockTraits = std::allocator_traits<BlockAllocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    CowVector() = default;
+
+    explicit CowVector(const Allocator& alloc) noexcept
+        : Allocator(alloc) {
+    }
+
+    explicit CowVector(size_t size, const Allocator& alloc = Allocator())
+        : Allocator(alloc)
+        , block_(MakeBlock(size, alloc)) {
+    }
+
+    CowVector(size_t size, const T& value, const Allocator& alloc = Allocator())
+        : Allocator(alloc)
+        , block_(MakeBlock(size, value, alloc)) {
+    }
+
+    CowVector(std::initializer_list<T> values, const Allocator& alloc = Allocator())
+        : Allocator(alloc)
+        , block_(MakeBlock(values, alloc)) {
+    }
+
+    // Забирает буфер вектора без копирования элементов
+    explicit CowVector(Data&& data)
+        : Allocator(data.GetAllocator())
+        , block_(MakeBlock(std::move(data))) {
+    }
+
+    CowVector(const CowVector& other)
+        : Allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.GetAlloc())) {
+        if (other.block_ == nullptr) {
+            return;
+        }
+        if (other.block_->shareable) {
+            other.block_->refs.fetch_add(1, std::memory_order_relaxed);
+            block_ = other.block_;
+        }
+        else {
+            block_ = MakeBlock(other.block_->data, GetAlloc());
+        }
+    }
+
+    CowVector(CowVector&& other) noexcept
+        : Allocator(std::move(other.GetAlloc()))
+        , block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    ~CowVector() {
+        Release(block_);
+    }
+
+    CowVector& operator=(const CowVector& rhs) {
+        if (this != &rhs) {
+            CowVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        if (this != &rhs) {
+            CowVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    void Swap(CowVector& other) noexcept {
+        using std::swap;
+        swap(GetAlloc(), other.GetAlloc());
+        swap(block_, other.block_);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return GetAlloc();
+    }
+
+    // Разделяет ли вектор буфер с другими копиями
+    bool IsShared() const noexcept {
+        return block_ != nullptr && block_->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    size_t Size() const noexcept {
+        return block_ != nullptr ? block_->data.Size() : 0;
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return block_ != nullptr ? block_->data.Capacity() : 0;
+    }
+
+    const_iterator begin() const noexcept {
+        return block_ != nullptr ? block_->data.begin() : nullptr;
+    }
+    const_iterator end() const noexcept {
+        return begin() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Доступ на запись: буфер становится единственным и больше не разделяется
+    iterator begin() {
+        return Mutable().begin();
+    }
+    iterator end() {
+        return Mutable().end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return block_->data[index];
+    }
+
+    T& operator[](size_t index) {
+        assert(index < Size());
+        return Mutable()[index];
+    }
+
+    VectorView<const T> View() const noexcept {
+        return VectorView<const T>(begin(), Size());
+    }
+
+    // Вектор с элементами для произвольных изменений. Прежние копии не затрагиваются
+    Data& Mutable() {
+        Data& data = Unshare();
+        block_->shareable = false;
+        return data;
+    }
+
+    // Заменяет элемент, не открывая доступа к буферу: вектор остаётся разделяемым
+    void Set(size_t index, T value) {
+        assert(index < Size());
+        Unshare()[index] = std::move(value);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Unshare().Reserve(new_capacity);
+    }
+
+    void Resize(size_t new_size) {
+        Unshare().Resize(new_size);
+    }
+
+    void PushBack(const T& value) {
+        // value может быть элементом этого же вектора, который перестанет быть доступен после копирования
+        if (IsShared()) {
+            T copy(value);
+            Unshare().PushBack(std::move(copy));
+        }
+        else {
+            Unshare().PushBack(value);
+        }
+    }
+
+    void PushBack(T&& value) {
+        Unshare().PushBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        T value(std::forward<Args>(args)...);
+        return Mutable().EmplaceBack(std::move(value));
+    }
+
+    void PopBack() {
+        assert(Size() > 0);
+        Unshare().PopBack();
+    }
+
+    const_iterator Insert(const_iterator pos, const T& value) {
+        T copy(value);
+        return Insert(pos, std::move(copy));
+    }
+
+    const_iterator Insert(const_iterator pos, T&& value) {
+        const size_t index = pos - cbegin();
+        Data& data = Unshare();
+        return data.Insert(data.cbegin() + index, std::move(value));
+    }
+
+    const_iterator Erase(const_iterator pos) {
+        const size_t index = pos - cbegin();
+        Data& data = Unshare();
+        return data.Erase(data.cbegin() + index);
+    }
+
+    const_iterator Erase(const_iterator first, const_iterator last) {
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+        Data& data = Unshare();
+        return data.Erase(data.cbegin() + index, data.cbegin() + index + count);
+    }
+
+    // Разделяемый буфер не копируется: вектор просто отказывается от него
+    void Clear() noexcept {
+        if (IsShared()) {
+            Release(std::exchange(block_, nullptr));
+        }
+        else if (block_ != nullptr) {
+            block_->data.Clear();
+            block_->shareable = true;
+        }
+    }
+
+private:
+    Allocator& GetAlloc() noexcept {
+        return static_cast<Allocator&>(*this);
+    }
+
+    const Allocator& GetAlloc() const noexcept {
+        return static_cast<const Allocator&>(*this);
+    }
+
+    template <typename... Args>
+    Block* MakeBlock(Args&&... args) {
+        BlockAllocator alloc(GetAlloc());
+        Block* block = BlockTraits::allocate(alloc, 1);
+        try {
+            ::new (static_cast<void*>(block)) Block(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            BlockTraits::deallocate(alloc, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    // Последний владелец разрушает блок. acq_rel упорядочивает чтения других владельцев
+    // перед разрушением элементов
+    void Release(Block* block) noexcept {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Блок мог создать другой владелец: освобождаем его тем же аллокатором, что и элементы
+            BlockAllocator alloc(block->data.GetAllocator());
+            block->~Block();
+            BlockTraits::deallocate(alloc, block, 1);
+        }
+    }
+
+    // Делает буфер единственным, копируя элементы, если он разделяется. Счётчик читается с acquire,
+    // чтобы чтения прежних владельцев завершились до изменения элементов
+    Data& Unshare() {
+        if (block_ == nullptr) {
+            block_ = MakeBlock(GetAlloc());
+        }
+        else if (block_->refs.load(std::memory_order_acquire) != 1) {
+            Block* copy = MakeBlock(block_->data, GetAlloc());
+            Release(std::exchange(block_, copy));
+        }
+        return block_->data;
+    }
+
+    Block* block_ = nullptr;
+};
@@ -0,0 +1,670 @@
+#pragma once
+#include "bit_vector.h"
+#include "vector.h"
+
+#include <functional>
+
+// Политики поиска в отсортированных ключах FlatSet и FlatMap. Index<Key, Allocator> хранит
+// дополнительные данные поиска: noexcept Rebuild(keys, size) вызывается после каждого изменения ключей,
+// LowerBound(keys, size, key, comp) возвращает индекс первого ключа, не меньшего key
+
+// Двоичный поиск без ветвлений: на каждом шаге выбор половины компилируется в условное
+// перемещение, поэтому ошибки предсказания переходов не зависят от искомого ключа
+struct BranchlessSearch {
+    template <typename Key, typename Allocator>
+    class Index {
+    public:
+        Index() = default;
+
+        explicit Index(const Allocator&) noexcept {
+        }
+
+        void Rebuild(const Key*, size_t) noexcept {
+        }
+
+        template <typename Compare>
+        size_t LowerBound(const Key* keys, size_t size, const Key& key, const Compare& comp) const {
+            if (size == 0) {
+                return 0;
+            }
+            const Key* base = keys;
+            while (size > 1) {
+                const size_t half = size / 2;
+                base = comp(base[half - 1], key) ? base + half : base;
+                size -= half;
+            }
+            return static_cast<size_t>(base - keys) + comp(*base, key);
+        }
+    };
+};
+
+// Поиск по копии ключей в порядке Эйтцингера (обход двоичного дерева в ширину): первые уровни
+// дерева лежат в нескольких соседних кэш-линиях, а потомки узла k — рядом, в 2k и 2k + 1.
+// Обходится в копию ключей и индекс на каждый ключ, а любое изменение перестраивает копию за O(n),
+// поэтому подходит для таблиц, которые строятся редко, а читаются часто
+struct EytzingerSearch {
+    template <typename Key, typename Allocator>
+    class Index {
+        using RankAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>;
+
+    public:
+        Index() = default;
+
+        explicit Index(const Allocator& alloc)
+            : tree_(alloc)
+            , ranks_(RankAllocator(alloc)) {
+        }
+
+        // Если копию построить не удалось (нет памяти или бросил конструктор ключа),
+        // поиск до следующей перестройки идёт по самим ключам
+        void Rebuild(const Key* keys, size_t size) noexcept {
+            try {
+                Vector<size_t, RankAllocator> ranks(size, ranks_.GetAllocator());
+                size_t next = 0;
+                FillRanks(ranks, next, 1);
+                Vector<Key, Allocator> tree(tree_.GetAllocator());
+                tree.Reserve(size);
+                for (size_t rank : ranks) {
+                    tree.EmplaceBack(keys[rank]);
+                }
+                tree_.Swap(tree);
+                ranks_.Swap(ranks);
+            }
+            catch (...) {
+                tree_.Clear();
+                ranks_.Clear();
+            }
+        }
+
+        template <typename Compare>
+        size_t LowerBound(const Key* keys, size_t size, const Key& key, const Compare& comp) const {
+            if (tree_.Size() != size) {
+                return BranchlessSearch::Index<Key, Allocator>().LowerBound(keys, size, key, comp);
+            }
+            const Key* tree = tree_.begin();
+            size_t k = 1;
+            while (k <= size) {
+                k = 2 * k + comp(tree[k - 1], key);
+            }
+            // Последний поворот налево ведёт к узлу с ответом: отбрасываем хвост поворотов направо
+            k >>= detail::CountTrailingZeros64(~static_cast<uint64_t>(k)) + 1;
+            return k == 0 ? size : ranks_[k - 1];
+        }
+
+    private:
+        // Симметричный обход дерева выдаёт узлы в порядке возрастания ключей
+        static void FillRanks(Vector<size_t, RankAllocator>& ranks, size_t& next, size_t k) noexcept {
+            if (k <= ranks.Size()) {
+                FillRanks(ranks, next, 2 * k);
+                ranks[k - 1] = next++;
+                FillRanks(ranks, next, 2 * k + 1);
+            }
+        }
+
+        Vector<Key, Allocator> tree_;
+        Vector<size_t, RankAllocator> ranks_;
+    };
+};
+
+// Множество на отсортированном Vector: поиск — двоичный поиск по непрерывному буферу вместо
+// перехода по указателям узлов дерева. Вставка и удаление одного ключа сдвигают хвост, поэтому
+// большие наборы ключей лучше добавлять разом через InsertSorted или Insert(first, last)
+template <typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>,
+          typename SearchPolicy = BranchlessSearch>
+class FlatSet : private Compare {
+    using Index = typename SearchPolicy::template Index<Key, Allocator>;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp, const Allocator& alloc = Allocator())
+        : Compare(comp)
+        , keys_(alloc)
+        , index_(alloc) {
+    }
+
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : FlatSet(comp, alloc) {
+        Insert(first, last);
+    }
+
+    FlatSet(std::initializer_list<Key> keys, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : FlatSet(keys.begin(), keys.end(), comp, alloc) {
+    }
+
+    void Swap(FlatSet& other) noexcept {
+        using std::swap;
+        swap(GetComp(), other.GetComp());
+        keys_.Swap(other.keys_);
+        swap(index_, other.index_);
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return keys_.Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        index_ = Index(keys_.GetAllocator());
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    VectorView<const Key> Keys() const noexcept {
+        return keys_.View();
+    }
+
+    // Индекс первого ключа, не меньшего key
+    size_t LowerBound(const Key& key) const {
+        return index_.LowerBound(keys_.begin(), keys_.Size(), key, GetComp());
+    }
+
+    const_iterator Find(const Key& key) const {
+        const size_t index = LowerBound(key);
+        return index != keys_.Size() && !GetComp()(key, keys_[index]) ? begin() + index : end();
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key);
+    }
+
+    std::pair<const_iterator, bool> Insert(const Key& key) {
+        return Emplace(key);
+    }
+
+    std::pair<const_iterator, bool> Insert(Key&& key) {
+        return Emplace(std::move(key));
+    }
+
+    template <typename... Args>
+    std::pair<const_iterator, bool> Emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        const size_t index = LowerBound(key);
+        if (index != keys_.Size() && !GetComp()(key, keys_[index])) {
+            return { begin() + index, false };
+        }
+        keys_.Emplace(keys_.cbegin() + index, std::move(key));
+        RebuildIndex();
+        return { begin() + index, true };
+    }
+
+    // Добавляет ключи из диапазона, отсортированного по возрастанию: они дописываются в конец,
+    // а затем сливаются с прежними за один проход. Ключи, которые уже есть, не добавляются
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    void InsertSorted(InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        try {
+            for (; first != last; ++first) {
+                auto&& key = *first;
+                assert(keys_.Size() == old_size || !GetComp()(key, keys_[keys_.Size() - 1]));
+                if (keys_.Size() == old_size || GetComp()(keys_[keys_.Size() - 1], key)) {
+                    keys_.EmplaceBack(std::forward<decltype(key)>(key));
+                }
+            }
+            MergeTail(old_size);
+        }
+        catch (...) {
+            keys_.Erase(keys_.cbegin() + old_size, keys_.cend());
+            throw;
+        }
+        RebuildIndex();
+    }
+
+    // Как InsertSorted, но диапазон произвольного порядка сначала сортируется
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    void Insert(InputIt first, InputIt last) {
+        Vector<Key, Allocator> keys(first, last, keys_.GetAllocator());
+        std::stable_sort(keys.begin(), keys.end(), std::cref(GetComp()));
+        InsertSorted(std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+    }
+
+    size_t Erase(const Key& key) {
+        const const_iterator pos = Find(key);
+        if (pos == end()) {
+            return 0;
+        }
+        Erase(pos);
+        return 1;
+    }
+
+    const_iterator Erase(const_iterator pos) {
+        const size_t index = pos - begin();
+        keys_.Erase(keys_.cbegin() + index);
+        RebuildIndex();
+        return begin() + index;
+    }
+
+    bool operator==(const FlatSet& rhs) const {
+        return Size() == rhs.Size() && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator!=(const FlatSet& rhs) const {
+        return !(*this == rhs);
+    }
+
+private:
+    const Compare& GetComp() const noexcept {
+        return *this;
+    }
+
+    Compare& GetComp() noexcept {
+        return *this;
+    }
+
+    // Сливает отсортированные ключи [0, old_size) и [old_size, Size()) в новый буфер.
+    // Если хвост целиком больше прежних ключей, буфер не перевыделяется
+    void MergeTail(size_t old_size) {
+        const size_t size = keys_.Size();
+        if (old_size == 0 || old_size == size || GetComp()(keys_[old_size - 1], keys_[old_size])) {
+            return;
+        }
+        Vector<Key, Allocator> merged(keys_.GetAllocator());
+        merged.Reserve(size);
+        size_t old_index = 0;
+        size_t new_index = old_size;
+        while (old_index < old_size && new_index < size) {
+            if (GetComp()(keys_[new_index], keys_[old_index])) {
+                merged.EmplaceBack(std::move_if_noexcept(keys_[new_index++]));
+            }
+            else {
+                new_index += !GetComp()(keys_[old_index], keys_[new_index]);
+                merged.EmplaceBack(std::move_if_noexcept(keys_[old_index++]));
+            }
+        }
+        for (; old_index < old_size; ++old_index) {
+            merged.EmplaceBack(std::move_if_noexcept(keys_[old_index]));
+        }
+        for (; new_index < size; ++new_index) {
+            merged.EmplaceBack(std::move_if_noexcept(keys_[new_index]));
+        }
+        keys_.Swap(merged);
+    }
+
+    void RebuildIndex() noexcept {
+        index_.Rebuild(keys_.begin(), keys_.Size());
+    }
+
+    Vector<Key, Allocator> keys_;
+    Index index_;
+};
+
+// Словарь на двух отсортированных Vector: ключи и значения лежат в отдельных буферах, поэтому
+// поиск читает только ключи. Элемент доступен парой ссылок, Find возвращает указатель на значение
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename KeyAllocator = std::allocator<Key>, typename ValueAllocator = std::allocator<Value>,
+          typename SearchPolicy = BranchlessSearch>
+class FlatMap : private Compare {
+    using Index = typename SearchPolicy::template Index<Key, KeyAllocator>;
+
+    template <bool IsConst>
+    class Iterator {
+        using Map = std::conditional_t<IsConst, const FlatMap, FlatMap>;
+        using MappedRef = std::conditional_t<IsConst, const Value&, Value&>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const Key&, MappedRef>;
+        using pointer = void;
+
+        Iterator() = default;
+
+        operator Iterator<true>() const noexcept {
+            return Iterator<true>(map_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return reference(map_->keys_[index_], map_->values_[index_]);
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator& other) const noexcept {
+            return index_ != other.index_;
+        }
+
+        const Key& GetKey() const noexcept {
+            return map_->keys_[index_];
+        }
+
+        MappedRef GetValue() const noexcept {
+            return map_->values_[index_];
+        }
+
+        // Номер элемента в порядке ключей
+        size_t Position() const noexcept {
+            return index_;
+        }
+
+    private:
+        friend class FlatMap;
+        template <bool>
+        friend class Iterator;
+
+        Iterator(Map* map, size_t index) noexcept
+            : map_(map)
+            , index_(index) {
+        }
+
+        Map* map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using key_compare = Compare;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp, const KeyAllocator& key_alloc = KeyAllocator(),
+                     const ValueAllocator& value_alloc = ValueAllocator())
+        : Compare(comp)
+        , keys_(key_alloc)
+        , values_(value_alloc)
+        , index_(key_alloc) {
+    }
+
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+        : FlatMap(comp) {
+        Insert(first, last);
+    }
+
+    FlatMap(std::initializer_list<std::pair<Key, Value>> items, const Compare& comp = Compare())
+        : FlatMap(items.begin(), items.end(), comp) {
+    }
+
+    void Swap(FlatMap& other) noexcept {
+        using std::swap;
+        swap(GetComp(), other.GetComp());
+        keys_.Swap(other.keys_);
+        values_.Swap(other.values_);
+        swap(index_, other.index_);
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::min(keys_.Capacity(), values_.Capacity());
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+        index_ = Index(keys_.GetAllocator());
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, Size());
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, Size());
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    VectorView<const Key> Keys() const noexcept {
+        return keys_.View();
+    }
+
+    // Значения в порядке ключей; менять их можно, ключи — нельзя
+    VectorView<Value> Values() noexcept {
+        return values_.View();
+    }
+
+    VectorView<const Value> Values() const noexcept {
+        return values_.View();
+    }
+
+    // Индекс первого ключа, не меньшего key
+    size_t LowerBound(const Key& key) const {
+        return index_.LowerBound(keys_.begin(), keys_.Size(), key, GetComp());
+    }
+
+    // Указатель на значение ключа или nullptr
+    Value* Find(const Key& key) {
+        return const_cast<Value*>(std::as_const(*this).Find(key));
+    }
+
+    const Value* Find(const Key& key) const {
+        const size_t index = LowerBound(key);
+        return index != keys_.Size() && !GetComp()(key, keys_[index]) ? &values_[index] : nullptr;
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != nullptr;
+    }
+
+    Value& At(const Key& key) {
+        return const_cast<Value&>(std::as_const(*this).At(key));
+    }
+
+    const Value& At(const Key& key) const {
+        if (const Value* value = Find(key)) {
+            return *value;
+        }
+        throw std::out_of_range("FlatMap key not found");
+    }
+
+    Value& operator[](const Key& key) {
+        return *TryEmplace(key).first;
+    }
+
+    // Добавляет значение из args, если ключа ещё нет
+    template <typename... Args>
+    std::pair<Value*, bool> TryEmplace(const Key& key, Args&&... args) {
+        const size_t index = LowerBound(key);
+        if (index != keys_.Size() && !GetComp()(key, keys_[index])) {
+            return { &values_[index], false };
+        }
+        keys_.Emplace(keys_.cbegin() + index, key);
+        try {
+            values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            keys_.Erase(keys_.cbegin() + index);
+            throw;
+        }
+        RebuildIndex();
+        return { &values_[index], true };
+    }
+
+    std::pair<Value*, bool> Insert(const Key& key, const Value& value) {
+        return TryEmplace(key, value);
+    }
+
+    std::pair<Value*, bool> Insert(const Key& key, Value&& value) {
+        return TryEmplace(key, std::move(value));
+    }
+
+    template <typename V>
+    std::pair<Value*, bool> InsertOrAssign(const Key& key, V&& value) {
+        auto result = TryEmplace(key, std::forward<V>(value));
+        if (!result.second) {
+            *result.first = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    // Добавляет пары (ключ, значение) из диапазона, отсортированного по ключам: они дописываются
+    // в конец, а затем сливаются с прежними за один проход. Значения ключей, которые уже есть,
+    // не меняются
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    void InsertSorted(InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        try {
+            for (; first != last; ++first) {
+                auto&& item = *first;
+                assert(keys_.Size() == old_size || !GetComp()(item.first, keys_[keys_.Size() - 1]));
+                if (keys_.Size() == old_size || GetComp()(keys_[keys_.Size() - 1], item.first)) {
+                    keys_.EmplaceBack(std::forward<decltype(item)>(item).first);
+                    values_.EmplaceBack(std::forward<decltype(item)>(item).second);
+                }
+            }
+            MergeTail(old_size);
+        }
+        catch (...) {
+            keys_.Erase(keys_.cbegin() + old_size, keys_.cend());
+            values_.Erase(values_.cbegin() + old_size, values_.cend());
+            throw;
+        }
+        RebuildIndex();
+    }
+
+    // Как InsertSorted, но диапазон произвольного порядка сначала сортируется по ключам
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    void Insert(InputIt first, InputIt last) {
+        Vector<std::pair<Key, Value>> items(first, last);
+        std::stable_sort(items.begin(), items.end(), [this](const auto& lhs, const auto& rhs) {
+            return GetComp()(lhs.first, rhs.first);
+        });
+        InsertSorted(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+    }
+
+    size_t Erase(const Key& key) {
+        const size_t index = LowerBound(key);
+        if (index == keys_.Size() || GetComp()(key, keys_[index])) {
+            return 0;
+        }
+        keys_.Erase(keys_.cbegin() + index);
+        values_.Erase(values_.cbegin() + index);
+        RebuildIndex();
+        return 1;
+    }
+
+private:
+    const Compare& GetComp() const noexcept {
+        return *this;
+    }
+
+    Compare& GetComp() noexcept {
+        return *this;
+    }
+
+    // Ключи и значения переносятся при слиянии одинаково: перемещаются, только если перемещение
+    // обоих не бросает исключений, иначе копируются, и исключение оставляет прежние элементы целыми
+    static constexpr bool kMoveOnMerge =
+        (std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<Value>)
+        || !std::is_copy_constructible_v<Key> || !std::is_copy_constructible_v<Value>;
+
+    template <typename U>
+    static decltype(auto) MergeSource(U& item) noexcept {
+        if constexpr (kMoveOnMerge) {
+            return std::move(item);
+        }
+        else {
+            return static_cast<const U&>(item);
+        }
+    }
+
+    // Сливает отсортированные элементы [0, old_size) и [old_size, Size()) в новые буферы
+    // ключей и значений. Если хвост целиком больше прежних ключей, буферы не перевыделяются
+    void MergeTail(size_t old_size) {
+        const size_t size = keys_.Size();
+        if (old_size == 0 || old_size == size || GetComp()(keys_[old_size - 1], keys_[old_size])) {
+            return;
+        }
+        Vector<Key, KeyAllocator> keys(keys_.GetAllocator());
+        Vector<Value, ValueAllocator> values(values_.GetAllocator());
+        keys.Reserve(size);
+        values.Reserve(size);
+        auto take = [&](size_t index) {
+            keys.EmplaceBack(MergeSource(keys_[index]));
+            values.EmplaceBack(MergeSource(values_[index]));
+        };
+        size_t old_index = 0;
+        size_t new_index = old_size;
+        while (old_index < old_size && new_index < size) {
+            if (GetComp()(keys_[new_index], keys_[old_index])) {
+                take(new_index++);
+            }
+            else {
+                new_index += !GetComp()(keys_[old_index], keys_[new_index]);
+                take(old_index++);
+            }
+        }
+        for (; old_index < old_size; ++old_index) {
+            take(old_index);
+        }
+        for (; new_index < size; ++new_index) {
+            take(new_index);
+        }
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+
+    void RebuildIndex() noexcept {
+        index_.Rebuild(keys_.begin(), keys_.Size());
+    }
+
+    Vector<Key, KeyAllocator> keys_;
+    Vector<Value, ValueAllocator> values_;
+    Index index_;
+};
@@ -0,0 +1,267 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Размещение страниц больших блоков по узлам NUMA
+enum class NumaPolicy {
+    kDefault,     // страница попадает на узел потока, первым обратившегося к ней
+    kBind,        // только узлы из numa_nodes
+    kInterleave,  // страницы распределяются по узлам из numa_nodes по очереди
+};
+
+struct HugePageOptions {
+    NumaPolicy numa_policy = NumaPolicy::kDefault;
+    // Битовая маска узлов NUMA для kBind и kInterleave
+    unsigned long numa_nodes = 0;
+    // Запрашивать явные huge pages (MAP_HUGETLB). Если они не зарезервированы в системе,
+    // используются прозрачные huge pages (MADV_HUGEPAGE)
+    bool use_hugetlb = false;
+    // Число потоков, которые заранее обращаются к страницам нового блока, чтобы ошибки страниц
+    // обрабатывались параллельно, а при kDefault страницы распределялись между узлами этих потоков.
+    // 0 — страницы выделяются при первом обращении
+    unsigned prefault_threads = 0;
+};
+
+namespace detail {
+
+inline constexpr size_t kHugePageSize = size_t{2} << 20;
+
+inline size_t RoundUpToHugePage(size_t bytes) noexcept {
+    return (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+}
+
+#if defined(__linux__)
+
+// Применяет к блоку политику NUMA и просьбу использовать прозрачные huge pages.
+// Это лишь подсказки ядру, поэтому их ошибки игнорируются
+inline void AdviseLargeBlock(void* p, size_t length, const HugePageOptions& options) noexcept {
+    ::madvise(p, length, MADV_HUGEPAGE);
+    if (options.numa_policy != NumaPolicy::kDefault && options.numa_nodes != 0) {
+        const int mode = options.numa_policy == NumaPolicy::kBind ? MPOL_BIND : MPOL_INTERLEAVE;
+        const unsigned long max_node = std::numeric_limits<unsigned long>::digits;
+        ::syscall(SYS_mbind, p, length, mode, &options.numa_nodes, max_node, MPOL_MF_MOVE);
+    }
+}
+
+// Обращается к каждой странице блока из нескольких потоков
+inline void PrefaultLargeBlock(void* p, size_t length, unsigned threads) {
+    auto* bytes = static_cast<unsigned char*>(p);
+    const size_t pages = length / kHugePageSize;
+    auto touch = [bytes, length](size_t first_page, size_t last_page) {
+        constexpr size_t kPageSize = 4096;
+        for (size_t offset = first_page * kHugePageSize; offset < last_page * kHugePageSize && offset < length;
+             offset += kPageSize) {
+            bytes[offset] = 0;
+        }
+    };
+    threads = static_cast<unsigned>(std::min<size_t>(threads, pages));
+    if (threads <= 1) {
+        touch(0, pages);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    const size_t per_thread = (pages + threads - 1) / threads;
+    try {
+        for (unsigned i = 1; i < threads; ++i) {
+            workers.emplace_back(touch, i * per_thread, std::min(pages, (i + 1) * per_thread));
+        }
+    }
+    catch (...) {
+        // Не удалось создать поток: оставшиеся страницы выделятся при первом обращении
+    }
+    touch(0, per_thread);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Отображает блок, выровненный по границе huge page, чтобы ядро могло использовать их целиком
+inline void* MapLargeBlock(size_t length, const HugePageOptions& options) {
+    if (options.use_hugetlb) {
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+    }
+    void* raw = ::mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    auto* begin = static_cast<unsigned char*>(raw);
+    auto* aligned = reinterpret_cast<unsigned char*>(RoundUpToHugePage(reinterpret_cast<uintptr_t>(begin)));
+    if (aligned != begin) {
+        ::munmap(begin, aligned - begin);
+    }
+    const size_t tail = (begin + length + kHugePageSize) - (aligned + length);
+    if (tail != 0) {
+        ::munmap(aligned + length, tail);
+    }
+    return aligned;
+}
+
+inline void* AllocateLargeBlock(size_t length, const HugePageOptions& options) {
+    void* p = MapLargeBlock(length, options);
+    AdviseLargeBlock(p, length, options);
+    if (options.prefault_threads != 0) {
+        PrefaultLargeBlock(p, length, options.prefault_threads);
+    }
+    return p;
+}
+
+// Применяет подсказки к перенесённому блоку. Страницы, добавленные при росте, заполняются
+// заранее так же, как страницы нового блока
+inline void AdviseRemappedBlock(void* p, size_t old_length, size_t new_length, const HugePageOptions& options) {
+    AdviseLargeBlock(p, new_length, options);
+    if (options.prefault_threads != 0 && new_length > old_length) {
+        PrefaultLargeBlock(static_cast<unsigned char*>(p) + old_length, new_length - old_length,
+                           options.prefault_threads);
+    }
+}
+
+// Переносит страницы блока в новый выровненный участок без копирования данных.
+// Возвращает nullptr, если ядро не может перенести отображение (например, для MAP_HUGETLB)
+inline void* RemapLargeBlock(void* p, size_t old_length, size_t new_length, const HugePageOptions& options) {
+    void* in_place = ::mremap(p, old_length, new_length, 0);
+    if (in_place != MAP_FAILED) {
+        AdviseRemappedBlock(p, old_length, new_length, options);
+        return p;
+    }
+    void* target = MapLargeBlock(new_length, HugePageOptions{});
+    void* moved = ::mremap(p, old_length, new_length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (moved == MAP_FAILED) {
+        ::munmap(target, new_length);
+        return nullptr;
+    }
+    AdviseRemappedBlock(moved, old_length, new_length, options);
+    return moved;
+}
+
+inline void FreeLargeBlock(void* p, size_t length) noexcept {
+    ::munmap(p, length);
+}
+
+#else
+
+inline void* AllocateLargeBlock(size_t length, const HugePageOptions&) {
+    return ::operator new(length, std::align_val_t{ kHugePageSize });
+}
+
+inline void* RemapLargeBlock(void*, size_t, size_t, const HugePageOptions&) {
+    return nullptr;
+}
+
+inline void FreeLargeBlock(void* p, size_t) noexcept {
+    ::operator delete(p, std::align_val_t{ kHugePageSize });
+}
+
+#endif
+
+}  // namespace detail
+
+// Аллокатор для больших векторов. Блоки от ThresholdBytes байт выделяются через mmap
+// с выравниванием по 2 МБ и MADV_HUGEPAGE (или MAP_HUGETLB), к ним применяется политика NUMA
+// и при необходимости параллельное первое обращение к страницам. Меньшие блоки выделяются
+// через operator new. Метод reallocate переносит большие блоки через mremap без копирования
+template <typename T, size_t ThresholdBytes = (size_t{4} << 20)>
+class HugePageAllocator {
+    template <typename U, size_t>
+    friend class HugePageAllocator;
+
+public:
+    using value_type = T;
+    // Способ освобождения определяется только размером блока, поэтому память, выделенная
+    // одним экземпляром, может быть освобождена любым другим
+    using is_always_equal = std::true_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, ThresholdBytes>;
+    };
+
+    HugePageAllocator() noexcept = default;
+
+    explicit HugePageAllocator(const HugePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, ThresholdBytes>& other) noexcept
+        : options_(other.options_) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (IsLarge(bytes)) {
+            return static_cast<T*>(detail::AllocateLargeBlock(detail::RoundUpToHugePage(bytes), options_));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsLarge(bytes)) {
+            detail::FreeLargeBlock(p, detail::RoundUpToHugePage(bytes));
+        }
+        else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    // Содержимое буфера переносится побайтово, поэтому вызывать можно только для тривиально перемещаемых T
+    T* reallocate(T* p, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = new_n * sizeof(T);
+        if (IsLarge(old_bytes) && IsLarge(new_bytes)) {
+            const size_t old_length = detail::RoundUpToHugePage(old_bytes);
+            const size_t new_length = detail::RoundUpToHugePage(new_bytes);
+            if (old_length == new_length) {
+                return p;
+            }
+            if (void* moved = detail::RemapLargeBlock(p, old_length, new_length, options_)) {
+                return static_cast<T*>(moved);
+            }
+        }
+        T* new_p = allocate(new_n);
+        std::memcpy(static_cast<void*>(new_p), static_cast<const void*>(p), std::min(old_bytes, new_bytes));
+        deallocate(p, old_n);
+        return new_p;
+    }
+
+    const HugePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U, ThresholdBytes>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U, ThresholdBytes>&) const noexcept {
+        return false;
+    }
+
+private:
+    static bool IsLarge(size_t bytes) noexcept {
+        return bytes >= ThresholdBytes;
+    }
+
+    HugePageOptions options_;
+};
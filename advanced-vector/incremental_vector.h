@@ -0,0 +1,289 @@
+#pragma once
+#include "vector.h"
+
+// Вектор с постепенной реаллокацией. При заполнении ёмкости выделяется новый буфер, но элементы
+// переносятся в него не сразу, а порциями при последующих добавлениях (как при инкрементальном
+// рехешировании), поэтому ни одна операция EmplaceBack не переносит больше step элементов.
+// Пока перенос не завершён, элементы [migrated, old_size) остаются в старом буфере; доступ по индексу
+// учитывает оба буфера. Непрерывный массив доступен через Data(), begin() и end(), которые
+// сначала завершают перенос. Размер порции выбирается так, чтобы перенос закончился раньше,
+// чем заполнится новый буфер, и не бывает меньше MinMigrationStep. Под ASan ёмкость не размечается:
+// во время переноса живые элементы нового буфера не образуют непрерывного префикса
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          size_t MinMigrationStep = 4>
+class IncrementalVector {
+    static_assert(MinMigrationStep > 0, "MinMigrationStep must be positive");
+
+    using Memory = RawMemory<T, Allocator>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static constexpr bool kRelocateBitwise = detail::kRelocateBitwise<T, Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Allocator& alloc) noexcept
+        : data_(alloc)
+        , old_(alloc) {
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+        , old_(data_.GetAllocator())
+    {
+        detail::UninitializedInitN(GetAlloc(), data_.GetAddress(), other.size_, [this, &other](T* place, size_t i) {
+            AllocTraits::construct(GetAlloc(), place, other[i]);
+        });
+        size_ = other.size_;
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_(std::move(other.old_))
+        , size_(std::exchange(other.size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0))
+        , old_size_(std::exchange(other.old_size_, 0))
+        , step_(std::exchange(other.step_, 0)) {
+    }
+
+    ~IncrementalVector() {
+        DestroyAll();
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            IncrementalVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value) {
+                StealStorage(rhs);
+            }
+            else if (GetAlloc() == rhs.GetAlloc()) {
+                StealStorage(rhs);
+            }
+            else {
+                // Чужие буферы забрать нельзя - перемещаем элементы в память своего аллокатора
+                IncrementalVector tmp(GetAlloc());
+                tmp.Reserve(rhs.size_);
+                detail::UninitializedInitN(tmp.GetAlloc(), tmp.data_.GetAddress(), rhs.size_,
+                                           [&tmp, &rhs](T* place, size_t i) {
+                    AllocTraits::construct(tmp.GetAlloc(), place, std::move(rhs[i]));
+                });
+                tmp.size_ = rhs.size_;
+                Swap(tmp);
+            }
+        }
+        return *this;
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(step_, other.step_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // Остались ли элементы в старом буфере
+    bool IsMigrating() const noexcept {
+        return migrated_ < old_size_;
+    }
+
+    // Переносит все оставшиеся элементы в новый буфер и освобождает старый
+    void FinishMigration() {
+        if (IsMigrating()) {
+            MigrateN(old_size_ - migrated_);
+        }
+    }
+
+    // Явное резервирование переносит все элементы сразу
+    void Reserve(size_t new_capacity) {
+        FinishMigration();
+        if (new_capacity <= data_.Capacity()) {
+            return;
+        }
+        Memory new_data(new_capacity, GetAlloc());
+        RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        data_.Swap(new_data);
+    }
+
+    T* Data() {
+        FinishMigration();
+        return data_.GetAddress();
+    }
+
+    iterator begin() {
+        return Data();
+    }
+
+    iterator end() {
+        return Data() + size_;
+    }
+
+    // Константный обход возможен только после завершения переноса
+    const_iterator begin() const noexcept {
+        assert(!IsMigrating());
+        return data_.GetAddress();
+    }
+
+    const_iterator end() const noexcept {
+        assert(!IsMigrating());
+        return data_.GetAddress() + size_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index >= migrated_ && index < old_size_ ? old_[index] : data_[index];
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Новый элемент создаётся до переноса очередной порции, поэтому args могут ссылаться
+    // на элементы самого вектора. Если перенос порции выбросит исключение, новый элемент разрушается
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == data_.Capacity()) {
+            StartMigration();
+        }
+        T* place = data_ + size_;
+        AllocTraits::construct(GetAlloc(), place, std::forward<Args>(args)...);
+        if (IsMigrating()) {
+            try {
+                MigrateN(std::min(step_, old_size_ - migrated_));
+            }
+            catch (...) {
+                AllocTraits::destroy(GetAlloc(), place);
+                throw;
+            }
+        }
+        ++size_;
+        return *place;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        AllocTraits::destroy(GetAlloc(), &(*this)[size_ - 1]);
+        --size_;
+        if (size_ < old_size_) {
+            old_size_ = size_;
+            if (!IsMigrating()) {
+                ReleaseOld();
+            }
+        }
+    }
+
+    void Clear() noexcept {
+        DestroyAll();
+        size_ = 0;
+    }
+
+private:
+    Allocator& GetAlloc() noexcept {
+        return data_.GetAllocator();
+    }
+
+    void StealStorage(IncrementalVector& rhs) noexcept {
+        DestroyAll();
+        data_ = std::move(rhs.data_);
+        old_ = std::move(rhs.old_);
+        size_ = std::exchange(rhs.size_, 0);
+        migrated_ = std::exchange(rhs.migrated_, 0);
+        old_size_ = std::exchange(rhs.old_size_, 0);
+        step_ = std::exchange(rhs.step_, 0);
+    }
+
+    // Выделяет новый буфер, оставляя все элементы в старом
+    void StartMigration() {
+        // Перенос предыдущей реаллокации всегда успевает завершиться до заполнения буфера
+        FinishMigration();
+        const size_t new_capacity = GrowthPolicy::template NextCapacity<T>(data_.Capacity(), size_ + 1);
+        Memory new_data(new_capacity, GetAlloc());
+        old_ = std::move(data_);
+        data_ = std::move(new_data);
+        migrated_ = 0;
+        old_size_ = size_;
+        const size_t free_slots = new_capacity - size_;
+        step_ = std::max(MinMigrationStep, (size_ + free_slots - 1) / free_slots);
+    }
+
+    // Переносит count очередных элементов из старого буфера в новый
+    void MigrateN(size_t count) {
+        assert(migrated_ + count <= old_size_);
+        RelocateN(old_ + migrated_, count, data_ + migrated_);
+        migrated_ += count;
+        if (!IsMigrating()) {
+            ReleaseOld();
+        }
+    }
+
+    // Переносит count элементов из src в dest и разрушает исходные. Если перемещение может бросать,
+    // элементы копируются, и при исключении исходные остаются нетронутыми
+    void RelocateN(T* src, size_t count, T* dest) {
+        if constexpr (kRelocateBitwise) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src), count * sizeof(T));
+            }
+        }
+        else {
+            detail::UninitializedMoveIfNoexceptN(GetAlloc(), src, count, dest);
+            detail::DestroyN(GetAlloc(), src, count);
+        }
+    }
+
+    void ReleaseOld() noexcept {
+        old_ = Memory(GetAlloc());
+        migrated_ = 0;
+        old_size_ = 0;
+    }
+
+    void DestroyAll() noexcept {
+        const size_t old_end = std::min(old_size_, size_);
+        detail::DestroyN(GetAlloc(), data_.GetAddress(), std::min(migrated_, size_));
+        if (migrated_ < old_end) {
+            detail::DestroyN(GetAlloc(), old_ + migrated_, old_end - migrated_);
+        }
+        const size_t new_begin = std::max(migrated_, old_end);
+        if (new_begin < size_) {
+            detail::DestroyN(GetAlloc(), data_ + new_begin, size_ - new_begin);
+        }
+        ReleaseOld();
+    }
+
+    Memory data_;
+    Memory old_;
+    size_t size_ = 0;
+    // Элементы с индексами [migrated_, old_size_) ещё находятся в старом буфере
+    size_t migrated_ = 0;
+    size_t old_size_ = 0;
+    size_t step_ = 0;
+};
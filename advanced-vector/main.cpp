@@ -1,8 +1,32 @@
 #include "vector.h"
+#include "small_vector.h"
+#include "concurrent_vector.h"
+#include "segmented_vector.h"
+#include "incremental_vector.h"
+#include "mapped_vector.h"
+#include "huge_page_allocator.h"
+#include "vector_simd.h"
+#include "pmr_vector.h"
+#include "vector_io.h"
+#include "soa_vector.h"
+#include "cow_vector.h"
+#include "static_vector.h"
+#include "bit_vector.h"
+#include "flat_map.h"
 
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -542,8 +566,9 @@ void Test6() {
         assert(Obj::num_copied == 0);
         assert(Obj::num_default_constructed == SIZE);
         assert(Obj::num_constructed_with_id_and_name == 1);
-        assert(Obj::num_moved == old_num_moved + 1);
-        assert(Obj::num_move_assigned == SIZE - 3);
+        // Хвост переносится конструктором перемещения, а новый элемент создаётся на месте
+        assert(Obj::num_moved == old_num_moved + static_cast<int>(SIZE) - 3);
+        assert(Obj::num_move_assigned == 0);
         assert(Obj::num_assigned == 0);
     }
     {
@@ -563,86 +588,2100 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit CountingAllocator(int id = 0) noexcept
+        : id(id) {
+    }
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : id(other.id) {
+    }
+
+    T* allocate(size_t n) {
+        if (fail_countdown > 0 && --fail_countdown == 0) {
+            throw std::bad_alloc();
+        }
+        ++num_allocations;
+        return static_cast<T*>(operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        ++num_deallocations;
+        operator delete(p);
+    }
+
+    bool operator==(const CountingAllocator& other) const noexcept {
+        return id == other.id;
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    bool operator!=(const CountingAllocator& other) const noexcept {
+        return id != other.id;
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+
+    static void ResetCounters() {
+        num_allocations = 0;
+        num_deallocations = 0;
+        fail_countdown = 0;
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+
+    int id = 0;
+    static inline int num_allocations = 0;
+    static inline int num_deallocations = 0;
+    // Если больше нуля, allocate с этим порядковым номером выбрасывает std::bad_alloc
+    static inline int fail_countdown = 0;
+};
+
+void Test7() {
+    const size_t SIZE = 10;
+    static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+    {
+        CountingAllocator<Obj>::ResetCounters();
+        Obj::ResetCounters();
+        {
+            Vector<Obj, CountingAllocator<Obj>> v(SIZE, CountingAllocator<Obj>(1));
+            v.PushBack(Obj{ 1 });
+            assert(v.Capacity() == SIZE * 2);
+            assert(v.GetAllocator().id == 1);
+            assert(CountingAllocator<Obj>::num_allocations == 2);
+            assert(CountingAllocator<Obj>::num_deallocations == 1);
+
+            Vector<Obj, CountingAllocator<Obj>> v_copy(v);
+            assert(v_copy.GetAllocator().id == 1);
+            assert(v_copy.Size() == SIZE + 1);
+
+            Vector<Obj, CountingAllocator<Obj>> other(CountingAllocator<Obj>(2));
+            other = v;
+            assert(other.GetAllocator().id == 1);
+            assert(other.Size() == SIZE + 1);
+
+            Vector<Obj, CountingAllocator<Obj>> moved(CountingAllocator<Obj>(3));
+            moved = std::move(v_copy);
+            assert(moved.GetAllocator().id == 1);
+            assert(moved.Size() == SIZE + 1);
+            assert(v_copy.Size() == 0);
         }
-        return *this;
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(CountingAllocator<Obj>::num_allocations == CountingAllocator<Obj>::num_deallocations);
+    }
+}
+
+struct Relocatable {
+    explicit Relocatable(int id)
+        : id(id) {
+    }
+    Relocatable(const Relocatable& other)
+        : id(other.id) {
+        ++num_copied;
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
+    Relocatable(Relocatable&& other) noexcept
+        : id(other.id) {
+        ++num_moved;
+    }
+    Relocatable& operator=(Relocatable&& other) noexcept {
+        id = other.id;
         return *this;
     }
-    ~C() {
-        ++dtor;
+    ~Relocatable() {
+        ++num_destroyed;
     }
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
     }
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+    int id = 0;
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+template <>
+struct is_trivially_relocatable<Relocatable> : std::true_type {
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-        << ", Copy ctors: "sv << C::copy_ctor          //
-        << ", Move ctors: "sv << C::move_ctor          //
-        << ", Copy assignments: "sv << C::copy_assign  //
-        << ", Move assignments: "sv << C::move_assign  //
-        << ", Dtors: "sv << C::dtor << endl;
+void Test8() {
+    const size_t SIZE = 100;
+    {
+        Relocatable::ResetCounters();
+        Vector<Relocatable> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.cbegin() + 1, -1);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0].id == 0 && v[1].id == -1 && v[2].id == 1 && v[SIZE].id == static_cast<int>(SIZE - 1));
+        assert(Relocatable::num_copied == 0);
+        // Ни рост вектора, ни сдвиг хвоста при вставке в середину не перемещают элементы поэлементно
+        assert(Relocatable::num_moved == 0);
+        assert(Relocatable::num_destroyed == 0);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Insert(v.cbegin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1 && *v[1] == 0 && *v[SIZE] == static_cast<int>(SIZE - 1));
+    }
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        v.PushBack(v[0]);
+        v.Emplace(v.cbegin() + 1, v[SIZE - 1]);
+        assert(v.Size() == SIZE + 2);
+        assert(v[0] == 0 && v[1] == static_cast<int>(SIZE - 1) && v[2] == 1 && v[SIZE + 1] == 0);
+        v.Reserve(SIZE * 10);
+        assert(v.Capacity() == SIZE * 10);
+        assert(v[SIZE] == static_cast<int>(SIZE - 1));
+    }
+    {
+        // n * sizeof(T) переполнился бы в 4 байта
+        MallocAllocator<int> alloc;
+        const size_t wrapping = std::numeric_limits<size_t>::max() / sizeof(int) + 2;
+        try {
+            [[maybe_unused]] int* p = alloc.allocate(wrapping);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+        int* p = alloc.allocate(1);
+        try {
+            p = alloc.reallocate(p, 1, wrapping);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+        alloc.deallocate(p, 1);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+void Test9() {
+    const size_t N = 8;
+    using SmallObjVector = SmallVector<Obj, N, CountingAllocator<Obj>>;
+    {
+        CountingAllocator<Obj>::ResetCounters();
+        Obj::ResetCounters();
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            SmallObjVector v;
+            assert(v.Capacity() == N);
+            for (size_t i = 0; i < N - 1; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            v.Insert(v.cbegin() + 1, Obj{ -1 });
+            v.Erase(v.cbegin() + 1);
+            v.EmplaceBack(static_cast<int>(N - 1));
+            assert(v.IsInline());
+            assert(v.Size() == N);
+            assert(CountingAllocator<Obj>::num_allocations == 0);
+
+            SmallObjVector v_copy(v);
+            SmallObjVector v_moved(std::move(v_copy));
+            assert(v_moved.IsInline());
+            assert(v_moved.Size() == N);
+            assert(v_moved[N - 1].id == static_cast<int>(N - 1));
+            assert(CountingAllocator<Obj>::num_allocations == 0);
+
+            v.PushBack(Obj{ static_cast<int>(N) });
+            assert(!v.IsInline());
+            assert(v.Capacity() == N * 2);
+            assert(v[0].id == 0 && v[N].id == static_cast<int>(N));
+            assert(CountingAllocator<Obj>::num_allocations == 1);
+
+            // Динамический буфер при перемещении не копируется
+            SmallObjVector v_heap(std::move(v));
+            assert(!v_heap.IsInline() && v_heap.Size() == N + 1);
+            assert(v.Size() == 0 && v.IsInline());
+            assert(CountingAllocator<Obj>::num_allocations == 1);
+
+            v_heap.Swap(v_moved);
+            assert(v_heap.Size() == N && v_moved.Size() == N + 1);
+            v = v_moved;
+            assert(v.Size() == N + 1 && v[N].id == static_cast<int>(N));
+            v_moved = v_heap;
+            assert(v_moved.Size() == N);
+
+            // Два динамических буфера меняются местами без перемещения элементов
+            static_assert(noexcept(v.Swap(v_heap)));
+            SmallObjVector other_heap(v);
+            other_heap.PushBack(Obj{ -1 });
+            const Obj* v_data = &v[0];
+            const Obj* other_data = &other_heap[0];
+            const int moves = Obj::num_moved;
+            const int allocations = CountingAllocator<Obj>::num_allocations;
+            v.Swap(other_heap);
+            assert(&v[0] == other_data && &other_heap[0] == v_data);
+            assert(v.Size() == N + 2 && v[N + 1].id == -1 && other_heap.Size() == N + 1);
+            assert(Obj::num_moved == moves && CountingAllocator<Obj>::num_allocations == allocations);
         }
-        Dump();
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(CountingAllocator<Obj>::num_allocations == CountingAllocator<Obj>::num_deallocations);
     }
-    catch (...) {
+    {
+        SmallVector<int, 4> v(10);
+        assert(!v.IsInline());
+        assert(v.Size() == 10 && v[9] == 0);
+        v.Resize(2);
+        assert(v.Size() == 2);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+}
+
+void Test10() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        v.PushBack(0);
+        // Первое выделение - не меньше 64 байт
+        assert(v.Capacity() == 64 / sizeof(int));
+        v.Resize(v.Capacity());
+        v.PushBack(1);
+        assert(v.Capacity() == 64 / sizeof(int) * 3 / 2);
+        assert(v[64 / sizeof(int)] == 1);
+    }
+    {
+        assert((GoldenRatioGrowth::NextCapacity<int>(1000, 1001) == 1618));
+        assert((FactorGrowth<3, 2, 0>::NextCapacity<int>(0, 1) == 1));
+        assert((FactorGrowth<3, 2, 0>::NextCapacity<int>(1, 2) == 2));
+        assert((DoublingGrowth::NextCapacity<int>(0, 1) == 1));
+        assert((DoublingGrowth::NextCapacity<int>(4, 100) == 100));
+    }
+    {
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(1) == 16);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(128) == 128);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(129) == 160);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(257) == 320);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(4097) == 5120);
+
+        struct Triple {
+            char data[3];
+        };
+        Vector<Triple, std::allocator<Triple>, SizeClassGrowth<>> v;
+        v.PushBack(Triple{});
+        assert(v.Capacity() == 5);
+        v.Resize(v.Capacity());
+        v.PushBack(Triple{});
+        assert(v.Capacity() == 10);
+        v.Resize(v.Capacity());
+        v.PushBack(Triple{});
+        assert(v.Capacity() == 21);
+    }
+}
+
+void Test11() {
+    const size_t SIZE = 10;
+    const size_t BATCH = 1000;
+    {
+        Vector<int> v{ 1, 2, 3 };
+        assert(v.Size() == 3 && v.Capacity() == 3);
+        assert(v[0] == 1 && v[2] == 3);
+        const std::vector<int> src{ 4, 5, 6, 7 };
+        Vector<int> v_range(src.begin(), src.end());
+        assert(v_range.Size() == src.size() && v_range.Capacity() == src.size());
+        assert(std::equal(v_range.begin(), v_range.end(), src.begin()));
+        Vector<int> v_fill(SIZE, 7);
+        assert(v_fill.Size() == SIZE && v_fill[SIZE - 1] == 7);
+
+        v.Insert(v.cbegin() + 1, src.begin(), src.end());
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 1, 4, 5, 6, 7, 2, 3 }));
+        v.Insert(v.cend() - 1, { 8, 9 });
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 1, 4, 5, 6, 7, 2, 8, 9, 3 }));
+        v.Insert(v.cbegin(), 2, v[8]);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{ 3, 3, 1, 4, 5, 6, 7, 2, 8, 9, 3 }));
+        v.AppendRange(src.begin(), src.begin() + 2);
+        assert(v.Size() == 13 && v[11] == 4 && v[12] == 5);
+
+        std::istringstream input("10 11 12");
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v[0] == 3 && v[1] == 10 && v[2] == 11 && v[3] == 12 && v[4] == 3);
+
+        v.Assign(src.begin(), src.end());
+        assert((std::vector<int>(v.begin(), v.end()) == src));
+        v.Assign(2, 0);
+        assert(v.Size() == 2 && v[0] == 0 && v[1] == 0);
+        v.Assign({ 1, 2, 3 });
+        assert(v.Size() == 3 && v[2] == 3);
+    }
+    {
+        Obj::ResetCounters();
+        CountingAllocator<Obj>::ResetCounters();
+        std::vector<Obj> batch(BATCH);
+        Vector<Obj, CountingAllocator<Obj>> v(SIZE);
+        // Вставка в середину без реаллокации - хвост сдвигается один раз
+        v.Reserve(SIZE + BATCH);
+        const int old_num_move_assigned = Obj::num_move_assigned;
+        const int old_num_moved = Obj::num_moved;
+        v.Insert(v.cbegin() + 1, batch.begin(), batch.end());
+        assert(v.Size() == SIZE + BATCH);
+        assert(Obj::num_moved - old_num_moved == static_cast<int>(SIZE - 1));
+        assert(Obj::num_move_assigned == old_num_move_assigned);
+        assert(Obj::num_copied + Obj::num_assigned == static_cast<int>(BATCH));
+
+        // При реаллокации память выделяется один раз
+        const int old_num_allocations = CountingAllocator<Obj>::num_allocations;
+        v.Insert(v.cbegin() + 2, batch.begin(), batch.end());
+        assert(v.Size() == SIZE + 2 * BATCH);
+        assert(CountingAllocator<Obj>::num_allocations == old_num_allocations + 1);
+
+        v.Insert(v.cbegin() + 3, SIZE, Obj{ 5 });
+        assert(v[3].id == 5 && v[3 + SIZE - 1].id == 5 && v[3 + SIZE].id == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        std::vector<Obj> batch(SIZE / 2);
+        batch[1].throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 1, batch.begin(), batch.end());
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + SIZE / 2));
+    }
+    {
+        SmallVector<int, 4> v{ 1, 2, 3 };
+        assert(v.IsInline() && v.Size() == 3);
+        v.Insert(v.cbegin(), { 4, 5 });
+        assert(!v.IsInline() && v[0] == 4 && v[4] == 3);
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, default_init);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        assert(Obj::num_default_constructed == SIZE);
+        v.ResizeUninitialized(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_default_constructed == SIZE * 2);
+        v.ResizeUninitialized(SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == SIZE / 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<char> v(SIZE, default_init);
+        std::memset(v.begin(), 'x', v.Size());
+        v.ResizeUninitialized(SIZE / 2);
+        v.ResizeUninitialized(SIZE);
+        // Память не обнуляется, поэтому прежнее содержимое сохраняется
+        assert(v[SIZE - 1] == 'x');
+        v.Resize(SIZE / 2);
+        v.Resize(SIZE);
+        assert(v[SIZE - 1] == 0);
+    }
+    {
+        SmallVector<int, 4> v(2, default_init);
+        assert(v.Size() == 2 && v.IsInline());
+    }
+}
+
+struct ThrowingMove {
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&&) {
+    }
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+};
+
+void Test13() {
+    const size_t SIZE = 16;
+    {
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth, VectorStats> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        const VectorStats& stats = v.GetStats();
+        // Ёмкости 1, 2, 4, 8, 16
+        assert(stats.allocations == 5);
+        assert(stats.allocated_bytes == 31 * sizeof(Obj));
+        assert(stats.reallocations == 4);
+        assert(stats.moved_elements == 15);
+        assert(stats.copied_elements == 0);
+        assert(stats.peak_capacity == SIZE);
+        v.Reserve(SIZE * 4);
+        assert(stats.peak_capacity == SIZE * 4);
+        assert(stats.moved_elements == 15 + SIZE);
+    }
+    {
+        Vector<ThrowingMove, std::allocator<ThrowingMove>, DoublingGrowth, VectorStats> v(SIZE);
+        v.PushBack(ThrowingMove{});
+        assert(v.GetStats().allocations == 2);
+        assert(v.GetStats().copied_elements == SIZE);
+        assert(v.GetStats().moved_elements == 0);
+    }
+    {
+        Vector<int, std::allocator<int>, DoublingGrowth, VectorStats> v(SIZE);
+        v.Insert(v.cbegin(), { 1, 2, 3 });
+        assert(v.GetStats().relocated_bitwise == SIZE);
+    }
+    static_assert(sizeof(Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats>) == sizeof(Vector<int>));
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Resize(SIZE / 2);
+        assert(v.Capacity() == SIZE);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::num_moved == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == SIZE / 2);
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v[SIZE / 4 - 1] = 42;
+        v.Resize(SIZE / 4);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 4 && v[SIZE / 4 - 1] == 42);
+    }
+    {
+        SmallVector<Obj, 4> v(SIZE);
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.IsInline() && v.Size() == 3 && v.Capacity() == 4);
+    }
+    {
+        Vector<int, std::allocator<int>, AutoShrinkGrowth<>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 128);
+        while (v.Size() > 32) {
+            v.PopBack();
+        }
+        assert(v.Capacity() == 64);
+        // Колебания размера около порога не вызывают перевыделений
+        v.PushBack(0);
+        v.PopBack();
+        assert(v.Capacity() == 64);
+        v.Erase(v.cbegin());
+        assert(v.Capacity() == 64);
+        v.Resize(1);
+        assert(v.Capacity() == 32 && v[0] == 1);
+        v.Clear();
+        assert(v.Capacity() == 16);
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth, VectorStats> v(SIZE);
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth, VectorStats> v_small(SIZE / 2);
+        v_small = v;
+        assert(v_small.Size() == SIZE && v_small.Capacity() == SIZE);
+        // Старые элементы не переносятся в новый буфер
+        assert(v_small.GetStats().allocations == 2);
+        assert(v_small.GetStats().reallocations == 0);
+        assert(Obj::num_copied == SIZE);
+        assert(Obj::num_moved == 0);
+        assert(Obj::GetAliveObjectCount() == 2 * SIZE);
+    }
+    {
+        Vector<int> v{ 1, 2, 3 };
+        Vector<int> v_copy(v, SIZE);
+        assert(v_copy.Size() == 3 && v_copy.Capacity() == SIZE);
+        assert(v_copy[0] == 1 && v_copy[2] == 3);
+        Vector<int> v_small(v, 1);
+        assert(v_small.Size() == 3 && v_small.Capacity() == 3);
+        v_copy.Resize(SIZE);
+        v = v_copy;
+        assert(v.Size() == SIZE && v[1] == 2 && v[SIZE - 1] == 0);
+        v_copy = v_small;
+        assert(v_copy.Size() == 3 && v_copy.Capacity() == SIZE && v_copy[2] == 3);
+    }
+}
+
+void Test16() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(pos == v.begin() + 2 && pos->id == 5);
+        assert(v.Size() == SIZE - 3);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 5));
+        assert(v.Erase(v.cbegin() + 1, v.cbegin() + 1) == v.begin() + 1);
+        assert(v.Size() == SIZE - 3);
+
+        pos = v.SwapErase(v.cbegin());
+        assert(pos->id == static_cast<int>(SIZE - 1) && v.Size() == SIZE - 4);
+        v.SwapErase(v.cend() - 1);
+        assert(v.Size() == SIZE - 5 && v[v.Size() - 1].id == 7);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 5));
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(EraseIf(v, [](int x) { return x % 3 == 0; }) == 34);
+        assert(v.Size() == 66 && v[0] == 1 && v[1] == 2 && v[2] == 4);
+        assert(std::is_sorted(v.begin(), v.end()));
+
+        assert(UnorderedEraseIf(v, [](int x) { return x % 2 == 0; }) == 33);
+        assert(v.Size() == 33);
+        assert(std::all_of(v.begin(), v.end(), [](int x) { return x % 2 != 0 && x % 3 != 0; }));
+        assert(UnorderedEraseIf(v, [](int) { return true; }) == 33 && v.Size() == 0);
+    }
+    {
+        SmallVector<int, 8> v{ 1, 2, 3, 4 };
+        assert(EraseIf(v, [](int x) { return x > 2; }) == 2);
+        assert(v.Size() == 2 && v[1] == 2);
+    }
+}
+
+void Test17() {
+    {
+        const int THREADS = 8;
+        const int PER_THREAD = 10000;
+        ConcurrentVector<int, std::allocator<int>, 4> v;
+        const int& first = v.EmplaceBack(-1);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&v, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    v.PushBack(t * PER_THREAD + i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const size_t total = THREADS * PER_THREAD + 1;
+        assert(v.Size() == total);
+        assert(&v[0] == &first && first == -1);
+
+        Vector<int> frozen = v.Freeze();
+        assert(v.Size() == 0);
+        assert(frozen.Size() == total);
+        std::sort(frozen.begin(), frozen.end());
+        for (size_t i = 0; i < total; ++i) {
+            assert(frozen[i] == static_cast<int>(i) - 1);
+        }
+    }
+    {
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            ConcurrentVector<Obj> v;
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceBack(i);
+            }
+            // Конструктор Obj(int) может бросать, поэтому каждый элемент перемещается ровно один раз
+            // из временного объекта; при росте элементы не перемещаются
+            assert(Obj::num_moved == 100);
+            assert(v[99].id == 99);
+            v.Clear();
+            assert(Obj::GetAliveObjectCount() == 0);
+            v.EmplaceBack(1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        ConcurrentVector<std::string> v;
+        v.EmplaceBack("hello");
+        v.PushBack(std::string(100, 'x'));
+        Vector<std::string> frozen = v.Freeze();
+        assert(frozen.Size() == 2 && frozen[0] == "hello" && frozen[1].size() == 100);
+    }
+    {
+        // Несостоявшееся выделение сегмента не занимает индекс: следующее добавление выделяет его снова
+        CountingAllocator<int>::ResetCounters();
+        ConcurrentVector<int, CountingAllocator<int>, 2> v;
+        v.PushBack(0);
+        v.PushBack(1);
+        CountingAllocator<int>::fail_countdown = 1;
+        try {
+            v.PushBack(2);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+        assert(v.Size() == 2);
+        for (int i = 2; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == 10 && v[2] == 2 && v[9] == 9);
+        Vector<int, CountingAllocator<int>> frozen = v.Freeze();
+        assert(frozen.Size() == 10);
+        for (int i = 0; i < 10; ++i) {
+            assert(frozen[i] == i);
+        }
+    }
+    assert(CountingAllocator<int>::num_allocations == CountingAllocator<int>::num_deallocations);
+}
+
+void Test18() {
+    {
+        Obj::ResetCounters();
+        SegmentedVector<Obj, std::allocator<Obj>, 4> v;
+        v.EmplaceBack(0);
+        Obj* first = &v[0];
+        for (int i = 1; i < 1000; ++i) {
+            v.EmplaceBack(i);
+        }
+        // Рост не перемещает элементы
+        assert(first == &v[0] && first->id == 0);
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(v.Size() == 1000 && v.Capacity() >= 1000);
+        for (int i = 0; i < 1000; ++i) {
+            assert(v[i].id == i);
+        }
+        assert(std::distance(v.begin(), v.end()) == 1000);
+        assert((v.end() - 1)->id == 999);
+
+        v.EmplaceBack(v[500]);
+        assert(v[1000].id == 500);
+        v.Erase(v.cbegin() + 10, v.cbegin() + 20);
+        assert(v.Size() == 991 && v[10].id == 20);
+        v.Insert(v.cbegin(), Obj(-1));
+        assert(v[0].id == -1 && v[1].id == 0 && v.Size() == 992);
+        v.PopBack();
+        assert(v.Size() == 991 && v[990].id == 999);
+
+        SegmentedVector<Obj, std::allocator<Obj>, 4> copy(v);
+        assert(copy.Size() == v.Size() && copy[500].id == v[500].id);
+        SegmentedVector<Obj, std::allocator<Obj>, 4> moved(std::move(copy));
+        assert(copy.Size() == 0 && moved.Size() == v.Size());
+        copy = moved;
+        assert(copy.Size() == moved.Size());
+
+        v.Resize(5);
+        v.ShrinkToFit();
+        assert(v.Size() == 5 && v.Capacity() == 12);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SegmentedVector<int> v{ 5, 3, 1, 4, 2 };
+        std::sort(v.begin(), v.end());
+        assert(std::is_sorted(v.cbegin(), v.cend()));
+        size_t chunks = 0;
+        v.ForEachChunk([&chunks](int*, size_t count) {
+            chunks += count;
+        });
+        assert(chunks == 5);
+    }
+}
+
+void Test19() {
+    {
+        Obj::ResetCounters();
+        IncrementalVector<Obj, std::allocator<Obj>, DoublingGrowth, 2> v;
+        for (int i = 0; i < 8; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 8 && !v.IsMigrating());
+        const int moves_before = Obj::num_moved;
+        // Рост выделяет новый буфер, но переносит только одну порцию элементов
+        v.EmplaceBack(v[0]);
+        assert(v.Capacity() == 16 && v.IsMigrating());
+        assert(Obj::num_moved - moves_before == 2);
+        for (int i = 0; i < 9; ++i) {
+            assert(v[i].id == (i == 8 ? 0 : i));
+        }
+        v.EmplaceBack(9);
+        v.EmplaceBack(10);
+        v.EmplaceBack(11);
+        assert(!v.IsMigrating());
+        assert(Obj::num_moved - moves_before == 8);
+
+        for (int i = 12; i < 17; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.IsMigrating());
+        // Удаление элементов, оставшихся в старом буфере, сокращает перенос
+        while (v.Size() > 3) {
+            v.PopBack();
+        }
+        assert(v.IsMigrating() && v[2].id == 2);
+        v.PopBack();
+        assert(!v.IsMigrating());
+        assert(v[0].id == 0 && v[1].id == 1);
+
+        for (int i = 2; i < 40; ++i) {
+            v.EmplaceBack(i);
+        }
+        IncrementalVector<Obj, std::allocator<Obj>, DoublingGrowth, 2> copy(v);
+        assert(copy.Size() == v.Size() && copy[39].id == 39);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        IncrementalVector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        for (int i = 0; i < 10000; ++i) {
+            v.PushBack(i);
+            assert(v[i / 2] == i / 2);
+        }
+        int* data = v.Data();
+        assert(!v.IsMigrating());
+        for (int i = 0; i < 10000; ++i) {
+            assert(data[i] == i);
+        }
+        v.Reserve(20000);
+        assert(v.Capacity() == 20000 && v[9999] == 9999);
+        IncrementalVector<int> moved(IncrementalVector<int>{});
+        assert(moved.Size() == 0);
+    }
+    {
+        // polymorphic_allocator не распространяется при перемещающем присваивании: буферы другого
+        // ресурса не забираются, элементы переносятся в память своего
+        using PmrIncremental = IncrementalVector<int, std::pmr::polymorphic_allocator<int>>;
+        static_assert(!std::is_nothrow_move_assignable_v<PmrIncremental>);
+        alignas(std::max_align_t) unsigned char own_buffer[1024];
+        alignas(std::max_align_t) unsigned char other_buffer[1024];
+        MonotonicArena own(own_buffer, sizeof(own_buffer), std::pmr::null_memory_resource());
+        MonotonicArena other(other_buffer, sizeof(other_buffer), std::pmr::null_memory_resource());
+        PmrIncremental v(&own);
+        v.PushBack(-1);
+        PmrIncremental source(&other);
+        for (int i = 0; i < 9; ++i) {
+            source.PushBack(i);
+        }
+        assert(source.IsMigrating());
+        v = std::move(source);
+        assert(v.Size() == 9 && !v.IsMigrating());
+        const int* data = v.Data();
+        assert(static_cast<const void*>(data) >= own_buffer && static_cast<const void*>(data) < own_buffer + sizeof(own_buffer));
+        for (int i = 0; i < 9; ++i) {
+            assert(data[i] == i);
+        }
+        // Буферы того же ресурса забираются без переноса
+        PmrIncremental same(&own);
+        same = std::move(v);
+        assert(same.Data() == data && same.Size() == 9);
+    }
+}
+
+void Test20() {
+    struct Point {
+        double x;
+        double y;
+    };
+    const std::string path = "mapped_vector_test.bin";
+    {
+        MappedVector<Point> v(path, MappedOpenMode::kCreate);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(Point{ static_cast<double>(i), -static_cast<double>(i) });
+        }
+        v.Insert(v.cbegin(), { Point{ -1, 1 }, Point{ -2, 2 } });
+        v.Erase(v.cbegin());
+        v.Advise(MappedAdvice::kSequential);
+        v.Sync();
+        v.PushBack(Point{ 1000, -1000 });
+    }
+    {
+        // Повторное открытие отображает файл без чтения элементов
+        MappedVector<Point> v(path, MappedOpenMode::kOpen);
+        assert(v.Size() == 1002);
+        assert(v[0].x == -2 && v[1].x == 0 && v[1001].x == 1000);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10);
+        MappedVector<Point> moved(std::move(v));
+        assert(moved.Size() == 10 && moved[9].y == -8);
+    }
+    {
+        MappedVector<Point> v(path);
+        assert(v.Size() == 10);
+        try {
+            MappedVector<int> wrong(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        try {
+            MappedVector<int> missing("no_such_dir/mapped.bin", MappedOpenMode::kOpen);
+            assert(false);
+        }
+        catch (const std::system_error&) {
+        }
+    }
+    std::remove(path.c_str());
+}
+
+void Test21() {
+    constexpr size_t kThreshold = size_t{1} << 20;
+    {
+        HugePageOptions options;
+        options.numa_policy = NumaPolicy::kInterleave;
+        options.numa_nodes = 1;
+        options.prefault_threads = 2;
+        using Allocator = HugePageAllocator<int, kThreshold>;
+        Vector<int, Allocator> v{ Allocator(options) };
+        const int SIZE = 1 << 20;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        // Большой блок выровнен по границе huge page
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % (size_t{2} << 20) == 0);
+        v.Resize(3 * SIZE);
+        for (int i = 0; i < SIZE; ++i) {
+            assert(v[i] == i);
+        }
+        assert(v[3 * SIZE - 1] == 0);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10 && v[9] == 9);
+
+        Vector<int, Allocator> copy(v);
+        assert(copy.Size() == 10 && copy.GetAllocator().GetOptions().prefault_threads == 2);
+    }
+#if defined(__linux__)
+    {
+        // Страницы, добавленные mremap при росте блока, заполняются заранее, как и при выделении
+        HugePageOptions options;
+        options.prefault_threads = 2;
+        HugePageAllocator<int, kThreshold> alloc(options);
+        const size_t n = kThreshold / sizeof(int);
+        int* p = alloc.allocate(n);
+        p = alloc.reallocate(p, n, 4 * n);
+        const size_t length = 4 * kThreshold;
+        const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> resident((length + page_size - 1) / page_size);
+        assert(::mincore(p, length, resident.data()) == 0);
+        assert(std::all_of(resident.begin(), resident.end(), [](unsigned char page) {
+            return (page & 1) != 0;
+        }));
+        alloc.deallocate(p, 4 * n);
+    }
+#endif
+    {
+        HugePageOptions options;
+        options.use_hugetlb = true;
+        Vector<std::string, HugePageAllocator<std::string, kThreshold>> v{ HugePageAllocator<std::string, kThreshold>(options) };
+        for (int i = 0; i < 100000; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        assert(v[99999] == "99999");
+    }
+}
+
+void Test22() {
+    {
+        AlignedVector<float, 32> v;
+        for (int i = 0; i < 13; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<uintptr_t>(v.begin()) % 32 == 0);
+        }
+        using Allocator = AlignedAllocator<float, 32>;
+        static_assert(Allocator::PaddedBytes(13) == 64 && Allocator::PaddedBytes(16) == 64);
+        // Хвост блока за последним элементом ёмкости обнулён и доступен для чтения целыми регистрами
+        v.ShrinkToFit();
+        assert(v.Capacity() == 13);
+        const float* data = v.begin();
+        for (size_t i = 13; i < Allocator::PaddedBytes(13) / sizeof(float); ++i) {
+            assert(data[i] == 0.0f);
+        }
+        AlignedVector<float, 32> copy(v);
+        assert(reinterpret_cast<uintptr_t>(copy.begin()) % 32 == 0 && copy[12] == 12.0f);
+    }
+    {
+        struct alignas(16) Vec4 {
+            float x, y, z, w;
+        };
+        Vector<Vec4, AlignedAllocator<Vec4, 64, 256>> v(5);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % 64 == 0);
+        v.Insert(v.cbegin(), Vec4{ 1, 2, 3, 4 });
+        assert(v.Size() == 6 && v[0].w == 4 && v[5].x == 0);
+    }
+    {
+        AlignedVector<std::string, 64> v;
+        v.EmplaceBack(100, 'a');
+        v.Insert(v.cbegin(), "b");
+        assert(v[0] == "b" && v[1].size() == 100);
+    }
+}
+
+void Test23() {
+    const simd::SimdLevel detected = simd::DetectSimdLevel();
+    const simd::SimdLevel levels[] = { simd::SimdLevel::kScalar, simd::SimdLevel::kSse42, simd::SimdLevel::kAvx2,
+                                       simd::SimdLevel::kAvx512, simd::SimdLevel::kNeon };
+    for (simd::SimdLevel level : levels) {
+        if (!simd::SetSimdLevel(level)) {
+            continue;
+        }
+        assert(simd::GetSimdLevel() == level);
+        for (int size : { 0, 1, 7, 16, 33, 1000 }) {
+            AlignedVector<int32_t> ints(size);
+            Vector<float> floats(size);
+            int64_t expected_sum = 0;
+            for (int i = 0; i < size; ++i) {
+                ints[i] = (i * 7919) % 1001 - 500;
+                floats[i] = static_cast<float>(ints[i]) * 0.5f;
+                expected_sum += ints[i];
+            }
+            assert(simd::Sum(ints) == static_cast<int32_t>(expected_sum));
+            assert(simd::Sum(floats) == static_cast<float>(expected_sum) * 0.5f);
+            assert(simd::Count(ints, 1000) == 0);
+            assert(simd::Find(floats, 1e9f) == floats.end());
+            if (size == 0) {
+                continue;
+            }
+            assert(simd::Min(ints) == *std::min_element(ints.begin(), ints.end()));
+            assert(simd::Max(floats) == *std::max_element(floats.begin(), floats.end()));
+            const int32_t last = ints[size - 1];
+            assert(simd::Count(ints, last) == static_cast<size_t>(std::count(ints.begin(), ints.end(), last)));
+            assert(simd::Find(ints, last) == std::find(ints.begin(), ints.end(), last));
+            assert(simd::Find(floats, floats[size / 2]) == std::find(floats.begin(), floats.end(), floats[size / 2]));
+
+            simd::MulAdd(ints.begin(), ints.end(), ints.begin(), 3, -1);
+            assert(ints[size - 1] == last * 3 - 1);
+            Vector<double> doubled(size);
+            simd::Transform(floats.begin(), floats.end(), doubled.begin(), [](float x) {
+                return static_cast<double>(x) * 2;
+            });
+            assert(doubled[size - 1] == static_cast<double>(floats[size - 1]) * 2);
+            simd::Fill(floats, 2.5f);
+            assert(simd::Count(floats, 2.5f) == static_cast<size_t>(size));
+        }
+    }
+    // Скалярная версия для типов без векторных ядер
+    Vector<double> values{ 3.0, 1.0, 2.0 };
+    assert(simd::Sum(values) == 6.0 && simd::Min(values) == 1.0 && simd::Max(values) == 3.0);
+    simd::SetSimdLevel(detected);
+}
+
+// Объект, бросающий исключение при создании с номером throw_at; счётчики общие для всех потоков
+struct ParallelCounted {
+    ParallelCounted() {
+        if (++constructed == throw_at) {
+            throw std::runtime_error("construction failed");
+        }
+        ++alive;
+    }
+    ParallelCounted(const ParallelCounted&) : ParallelCounted() {
+    }
+    ~ParallelCounted() {
+        --alive;
+    }
+    char payload[16] = {};
+    static inline std::atomic<int> constructed = 0;
+    static inline std::atomic<int> alive = 0;
+    static inline int throw_at = 0;
+};
+
+void Test24() {
+    const ParallelTag tag{ 4, 64 };
+    {
+        Vector<int> v(tag, 1000);
+        assert(v.Size() == 1000 && std::all_of(v.begin(), v.end(), [](int x) { return x == 0; }));
+        Vector<int> filled(tag, 1001, 7);
+        assert(filled.Size() == 1001 && filled[0] == 7 && filled[1000] == 7);
+        std::iota(v.begin(), v.end(), 0);
+        Vector<int> copy(tag, v);
+        assert(copy.Size() == v.Size() && std::equal(v.begin(), v.end(), copy.begin()));
+        copy.Resize(tag, 5000);
+        assert(copy.Size() == 5000 && copy[999] == 999 && copy[4999] == 0);
+        copy.Resize(tag, 10);
+        assert(copy.Size() == 10 && copy[9] == 9);
+    }
+    {
+        Vector<std::string> v(tag, 500, std::string(40, 'x'));
+        Vector<std::string> copy(tag, v);
+        assert(copy.Size() == 500 && copy[0] == v[0] && copy[499] == v[499]);
+    }
+    {
+        // Исключение в одной из частей: созданные объекты всех частей разрушаются
+        ParallelCounted::throw_at = 1500;
+        try {
+            Vector<ParallelCounted> v(tag, 4000);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(ParallelCounted::alive == 0);
+
+        ParallelCounted::throw_at = 0;
+        Vector<ParallelCounted> v(tag, 4000);
+        assert(ParallelCounted::alive == 4000);
+        ParallelCounted::constructed = 0;
+        ParallelCounted::throw_at = 2500;
+        try {
+            v.Resize(tag, 8000);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4000 && ParallelCounted::alive == 4000);
+        ParallelCounted::constructed = 0;
+        try {
+            Vector<ParallelCounted> copy(tag, v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(ParallelCounted::alive == 4000);
+    }
+}
+
+void Test25() {
+    // polymorphic_allocator не мешает побайтовому переносу тривиально перемещаемых элементов
+    static_assert(detail::kRelocateBitwise<int, std::pmr::polymorphic_allocator<int>>);
+    static_assert(!detail::kRelocateBitwise<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>>);
+    // Тривиально копируемые элементы копируются memcpy, а элементы, принимающие ресурс, — через construct
+    static_assert(detail::kPlainConstruct<std::pmr::polymorphic_allocator<int>, int>);
+    static_assert(!detail::kPlainConstruct<std::pmr::polymorphic_allocator<std::pmr::string>, std::pmr::string>);
+    {
+        // Инициализация по умолчанию не обнуляет память, полученную от ресурса
+        alignas(std::max_align_t) unsigned char buffer[256];
+        std::memset(buffer, 0xAB, sizeof(buffer));
+        MonotonicArena arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::Vector<unsigned char> v(16, default_init, &arena);
+        assert(std::count(v.begin(), v.end(), 0xAB) == 16);
+        v.ResizeUninitialized(32);
+        assert(std::count(v.begin(), v.end(), 0xAB) == 32);
+        pmr::Vector<unsigned char> copy(v, &arena);
+        assert(copy.Size() == 32 && std::equal(v.begin(), v.end(), copy.begin()));
+    }
+    {
+        MonotonicArena arena(1024);
+        pmr::Vector<int> v(&arena);
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == 1000 && v[999] == 999);
+        assert(arena.UpstreamBytes() >= 1000 * sizeof(int));
+        // Элементы получают ресурс вектора
+        pmr::Vector<std::pmr::string> strings(&arena);
+        strings.EmplaceBack(100, 'a');
+        strings.PushBack(std::pmr::string("b", &arena));
+        assert(strings[0].get_allocator().resource() == &arena);
+        assert(strings[1].get_allocator().resource() == &arena);
+        // Копия получает ресурс по умолчанию
+        pmr::Vector<int> copy(v);
+        assert(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        assert(std::equal(v.begin(), v.end(), copy.begin()));
+    }
+    {
+        unsigned char buffer[512];
+        MonotonicArena arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        void* p = arena.allocate(100, 8);
+        assert(p >= static_cast<void*>(buffer) && p < static_cast<void*>(buffer + sizeof(buffer)));
+        assert(reinterpret_cast<uintptr_t>(arena.allocate(1, 64)) % 64 == 0);
+        try {
+            [[maybe_unused]] void* overflow = arena.allocate(1000);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+        // Размер с запасом на выравнивание не должен переполняться в маленький блок
+        try {
+            MonotonicArena heap_arena;
+            [[maybe_unused]] void* wrapped = heap_arena.allocate(std::numeric_limits<size_t>::max() - 8, 64);
+            assert(false);
+        }
+        catch (const std::bad_alloc&) {
+        }
+        arena.Reset();
+        assert(arena.allocate(100, 8) == p);
+    }
+    {
+        MonotonicArena arena(256);
+        for (int round = 0; round < 3; ++round) {
+            pmr::Vector<std::string> v(&arena);
+            for (int i = 0; i < 100; ++i) {
+                v.EmplaceBack(50, 'x');
+            }
+        }
+        const size_t upstream = arena.UpstreamBytes();
+        arena.Reset();
+        assert(arena.UpstreamBytes() <= upstream && arena.UpstreamBytes() > 0);
+        arena.Release();
+        assert(arena.UpstreamBytes() == 0);
+    }
+    {
+        SizeClassPool pool;
+        void* a = pool.allocate(24, 8);
+        void* b = pool.allocate(24, 8);
+        assert(a != b && reinterpret_cast<uintptr_t>(a) % 32 == 0);
+        pool.deallocate(a, 24, 8);
+        assert(pool.allocate(30, 8) == a);
+        void* aligned = pool.allocate(8, 256);
+        assert(reinterpret_cast<uintptr_t>(aligned) % 256 == 0);
+        void* large = pool.allocate(10000);
+        pool.deallocate(large, 10000);
+        pool.deallocate(b, 24, 8);
+        pool.deallocate(aligned, 8, 256);
+
+        pmr::Vector<pmr::Vector<int>> nested(&pool);
+        for (int i = 0; i < 100; ++i) {
+            nested.EmplaceBack().Resize(static_cast<size_t>(i));
+        }
+        assert(nested[99].Size() == 99 && nested[99].GetAllocator().resource() == &pool);
+        pmr::SmallVector<int, 4> small(&pool);
+        small.Resize(100);
+        assert(small.Size() == 100);
+    }
+}
+
+void Test26() {
+    {
+        // Буфер, полученный от malloc (например, из слоя ввода-вывода), принимается без копирования
+        auto* raw = static_cast<int*>(std::malloc(8 * sizeof(int)));
+        for (int i = 0; i < 5; ++i) {
+            raw[i] = i;
+        }
+        auto v = Vector<int, MallocAllocator<int>>::Adopt(raw, 5, 8);
+        assert(v.begin() == raw && v.Size() == 5 && v.Capacity() == 8);
+        v.PushBack(5);
+        assert(v.begin() == raw && v[5] == 5);
+        v.Resize(100);
+        assert(v[4] == 4 && v[99] == 0);
+    }
+    {
+        Vector<std::string> v{ "a", "b", "c", "d" };
+        const std::string* data = v.begin();
+        VectorBuffer<std::string> buffer = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(buffer.Data() == data && buffer.Size() == 4 && buffer.View()[3] == "d");
+        VectorBuffer<std::string> moved = std::move(buffer);
+        assert(buffer.Size() == 0 && moved.Size() == 4);
+        auto back = Vector<std::string>::Adopt(std::move(moved));
+        assert(back.begin() == data && back.Size() == 4 && moved.Size() == 0 && back[0] == "a");
+        // Буфер, не переданный вектору, сам разрушает элементы
+        VectorBuffer<std::string> dropped = back.Release();
+        assert(dropped.Capacity() >= 4);
+    }
+    {
+        Vector<int> v{ 0, 1, 2, 3, 4, 5, 6, 7 };
+        VectorView<int> view = v.View();
+        assert(view.Size() == 8 && view.Data() == v.begin() && view.SizeBytes() == 8 * sizeof(int));
+        VectorView<int> middle = v.Subview(2, 3);
+        assert(middle.Size() == 3 && middle.Front() == 2 && middle.Back() == 4);
+        middle[0] = 20;
+        assert(v[2] == 20);
+        assert(v.Subview(6).Size() == 2 && v.Subview(8).Empty() && middle.Subview(1, 100).Size() == 2);
+        const Vector<int>& cv = v;
+        VectorView<const int> const_view = cv.View();
+        VectorView<const int> converted = view;
+        assert(std::equal(const_view.begin(), const_view.end(), converted.begin()));
+        assert(cv.Subview(1, 1)[0] == 1);
+
+        SmallVector<int, 4> small{ 1, 2, 3 };
+        assert(small.View().Size() == 3 && small.Subview(1)[1] == 3);
+    }
+    {
+        auto* raw = Vector<int>::allocator_type().allocate(4);
+        raw[0] = 42;
+        Vector<int, std::allocator<int>, DoublingGrowth, VectorStats> v =
+            Vector<int, std::allocator<int>, DoublingGrowth, VectorStats>::Adopt(raw, 1, 4);
+        VectorBuffer<int> buffer = v.Release();
+        int* leaked = buffer.Leak();
+        assert(leaked == raw && buffer.Data() == nullptr && buffer.Capacity() == 0);
+        std::allocator<int>().deallocate(leaked, 4);
+    }
+}
+
+void Test27() {
+    Vector<int> source(100'000);
+    std::iota(source.begin(), source.end(), 0);
+    {
+        std::stringstream stream;
+        WriteTo(stream, source);
+        assert(stream.str().size() == sizeof(VectorIoHeader) + source.Size() * sizeof(int));
+        Vector<int> copy{ 1, 2, 3 };
+        ReadFrom(stream, copy);
+        assert(copy.Size() == source.Size() && std::equal(source.begin(), source.end(), copy.begin()));
+    }
+    {
+        // Данные поступают порциями произвольного размера, за вектором в потоке идут другие байты
+        std::stringstream stream;
+        WriteTo(stream, source);
+        std::string bytes = stream.str() + "tail";
+        SmallVector<int, 8> copy;
+        VectorStreamReader reader(copy);
+        size_t offset = 0;
+        for (size_t step = 1; offset < bytes.size() && !reader.Done(); step = step * 3 % 1000 + 1) {
+            offset += reader.Feed(bytes.data() + offset, std::min(step, bytes.size() - offset));
+        }
+        assert(reader.Done() && bytes.substr(offset) == "tail");
+        assert(copy.Size() == source.Size() && copy[99'999] == 99'999);
+    }
+    {
+        Vector<double> empty;
+        std::stringstream stream;
+        WriteTo(stream, empty, VectorIoOptions{ false });
+        Vector<double> copy{ 1.0 };
+        ReadFrom(stream, copy);
+        assert(copy.Size() == 0);
+    }
+    auto expect_failure = [](const std::string& bytes, auto& target) {
+        std::stringstream stream(bytes);
+        try {
+            ReadFrom(stream, target);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(target.Size() == 0);
+    };
+    {
+        std::stringstream stream;
+        WriteTo(stream, source);
+        const std::string bytes = stream.str();
+        Vector<int> target;
+        expect_failure(bytes.substr(0, bytes.size() - 1), target);
+        std::string corrupted = bytes;
+        corrupted[sizeof(VectorIoHeader) + 12345] ^= 1;
+        expect_failure(corrupted, target);
+        Vector<int64_t> wrong_type;
+        expect_failure(bytes, wrong_type);
+        expect_failure("not a vector stream at all, just some text to fill the header", target);
+    }
+    {
+        const char* path = "vector_io_test.bin";
+        const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        assert(fd != -1);
+        WriteTo(fd, source);
+        WriteTo(fd, Vector<int>{ 7, 8 });
+        ::lseek(fd, 0, SEEK_SET);
+        Vector<int> first;
+        Vector<int> second;
+        ReadFrom(fd, first);
+        ReadFrom(fd, second);
+        ::close(fd);
+        std::remove(path);
+        assert(std::equal(source.begin(), source.end(), first.begin(), first.end()));
+        assert(second.Size() == 2 && second[1] == 8);
+    }
+}
+
+void Test28() {
+    {
+        SoAVector<int, double, std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() >= 100);
+        auto [id, weight, name] = v[42];
+        assert(id == 42 && weight == 21.0 && name == "42");
+        std::get<2>(v[42]) = "changed";
+        assert(std::get<2>(v[42]) == "changed");
+        v[0] = std::make_tuple(-1, -1.0, std::string("first"));
+        assert(std::get<0>(v[0]) == -1 && std::get<2>(v[0]) == "first");
+
+        VectorView<int> ids = v.Column<0>();
+        assert(ids.Size() == 100 && ids[99] == 99);
+        assert(std::accumulate(v.Column<1>().begin(), v.Column<1>().end(), 0.0) == 4950 * 0.5 - 1.0);
+
+        // Аргумент может ссылаться на элемент вектора, даже если EmplaceBack перевыделяет память
+        v.Resize(v.Capacity());
+        v.EmplaceBack(std::get<0>(v[1]), std::get<1>(v[1]), std::get<2>(v[1]));
+        assert(v.Column<2>().Back() == "1" && v.Column<0>().Back() == 1);
+
+        const SoAVector<int, double, std::string> copy = v;
+        assert(copy.Size() == v.Size() && std::get<2>(copy[42]) == "changed");
+        SoAVector<int, double, std::string> moved = std::move(v);
+        assert(moved.Size() == copy.Size() && v.Size() == 0);
+        moved.PopBack();
+        moved.PushBack(std::make_tuple(7, 7.0, std::string("seven")));
+        assert(std::get<0>(moved[moved.Size() - 1]) == 7);
+        moved.Resize(10);
+        assert(moved.Size() == 10 && copy.Column<0>()[9] == 9);
+        moved.Clear();
+        assert(moved.Empty());
+    }
+    {
+        // Исключение при переносе одного столбца не меняет вектор
+        struct CopyOnly {
+            CopyOnly(int id, int* alive)
+                : id(id)
+                , alive(alive) {
+                ++*alive;
+            }
+            CopyOnly(const CopyOnly& other)
+                : id(other.id)
+                , alive(other.alive) {
+                if (other.throw_on_copy) {
+                    throw std::runtime_error("Oops");
+                }
+                ++*alive;
+            }
+            ~CopyOnly() {
+                --*alive;
+            }
+            int id;
+            int* alive;
+            bool throw_on_copy = false;
+        };
+        int alive = 0;
+        SoAVector<std::unique_ptr<int>, CopyOnly> v;
+        v.Reserve(2);
+        v.EmplaceBack(std::make_unique<int>(1), CopyOnly(1, &alive));
+        v.EmplaceBack(std::make_unique<int>(2), CopyOnly(2, &alive));
+        std::get<1>(v[1]).throw_on_copy = true;
+        try {
+            v.EmplaceBack(std::make_unique<int>(3), CopyOnly(3, &alive));
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 2 && v.Capacity() == 2 && alive == 2);
+        assert(*std::get<0>(v[0]) == 1 && *std::get<0>(v[1]) == 2 && std::get<1>(v[1]).id == 2);
+        std::get<1>(v[1]).throw_on_copy = false;
+        v.EmplaceBack(std::make_unique<int>(3), CopyOnly(3, &alive));
+        assert(v.Size() == 3 && alive == 3 && *std::get<0>(v[2]) == 3);
+        v.Clear();
+        assert(alive == 0);
+    }
+}
+
+void Test29() {
+    {
+        CowVector<std::string> v{ "a", "b", "c" };
+        const std::string* data = v.cbegin();
+        CowVector<std::string> snapshot = v;
+        assert(v.IsShared() && snapshot.cbegin() == data);
+        // Первое изменение копирует элементы один раз, снимок остаётся прежним
+        v.PushBack("d");
+        assert(!v.IsShared() && !snapshot.IsShared());
+        assert(v.Size() == 4 && snapshot.Size() == 3 && snapshot.cbegin() == data);
+        v.Set(0, "z");
+        v.Erase(v.cbegin() + 1);
+        v.Insert(v.cbegin(), "first");
+        assert(v.Size() == 4 && v[0] == "first" && v[1] == "z" && v[3] == "d");
+        assert(snapshot[0] == "a" && snapshot[1] == "b");
+
+        // После неконстантного доступа копии глубокие: ссылка не должна менять снимок
+        std::string& first = v[0];
+        CowVector<std::string> deep = v;
+        assert(!v.IsShared() && deep.cbegin() != v.cbegin());
+        first = "changed";
+        assert(deep[0] == "first" && std::as_const(v)[0] == "changed");
+
+        // Очистка разделяемого вектора не копирует элементы
+        CowVector<std::string> shared = snapshot;
+        shared.Clear();
+        assert(shared.Empty() && snapshot.Size() == 3 && !snapshot.IsShared());
+    }
+    {
+        Vector<int> source(1000);
+        std::iota(source.begin(), source.end(), 0);
+        const int* data = source.begin();
+        CowVector<int> v(std::move(source));
+        assert(v.cbegin() == data && v.Size() == 1000);
+        CowVector<int> empty;
+        CowVector<int> empty_copy = empty;
+        empty_copy.PushBack(1);
+        assert(empty.Size() == 0 && empty_copy.Size() == 1);
+
+        // Читатели работают со своими снимками, пока писатель меняет свою копию
+        std::vector<std::thread> readers;
+        std::atomic<bool> ok = true;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([snapshot = v, &ok] {
+                for (int round = 0; round < 100; ++round) {
+                    int64_t sum = 0;
+                    for (int x : snapshot) {
+                        sum += x;
+                    }
+                    if (sum != 999 * 1000 / 2) {
+                        ok = false;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 1000; ++i) {
+            v.Set(static_cast<size_t>(i), -i);
+            v.PushBack(i);
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(ok && v.Size() == 2000 && v[999] == -999 && v[1999] == 999);
+    }
+}
+
+void Test30() {
+    {
+        StaticVector<int, 8> v{ 1, 2, 3 };
+        static_assert(sizeof(v) == 8 * sizeof(int) + sizeof(size_t));
+        assert(v.Size() == 3 && v.Capacity() == 8);
+        v.Insert(v.cbegin(), 0);
+        v.EmplaceBack(4);
+        v.Erase(v.cbegin() + 1);
+        assert(v.Size() == 4 && v[0] == 0 && v[1] == 2 && v[3] == 4);
+        v.Resize(8);
+        assert(v.Full());
+        try {
+            v.PushBack(9);
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+        assert(v.Size() == 8 && v[3] == 4);
+        try {
+            v.Reserve(9);
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+        v.ShrinkToFit();
+        assert(v.Capacity() == 8);
+        EraseIf(v, [](int x) { return x == 0; });
+        assert(v.Size() == 3 && v[0] == 2);
+    }
+    {
+        StaticVector<std::string, 4> v;
+        v.PushBack("a");
+        v.EmplaceBack(50, 'b');
+        v.Insert(v.cbegin(), "c");
+        StaticVector<std::string, 4> copy = v;
+        StaticVector<std::string, 4> moved = std::move(v);
+        assert(copy.Size() == 3 && moved.Size() == 3 && copy[0] == "c" && moved[2] == std::string(50, 'b'));
+        copy = StaticVector<std::string, 4>{ "x" };
+        assert(copy.Size() == 1 && copy[0] == "x");
+        static_assert(noexcept(copy.Swap(moved)));
+        copy.Swap(moved);
+        assert(copy.Size() == 3 && moved.Size() == 1);
+        try {
+            copy.Insert(copy.cbegin() + 1, { "1", "2" });
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+        assert(copy.Size() == 3 && copy[1] == "a");
+        copy.Clear();
+        assert(copy.Size() == 0);
+    }
+}
+
+void Test31() {
+    {
+        BitVector<> bits(130);
+        assert(bits.Size() == 130 && bits.Count() == 0 && bits.None());
+        assert(bits.FindFirst() == BitVector<>::npos);
+        bits[3] = true;
+        bits.Set(64);
+        bits.Set(129);
+        assert(bits.Count() == 3 && bits[64] && !bits[65]);
+        assert(bits.FindFirst() == 3 && bits.FindNext(4) == 64 && bits.FindNext(65) == 129);
+        bits.Flip(3);
+        assert(!bits.Test(3) && bits.FindFirst() == 64);
+        bits.Flip();
+        assert(bits.Count() == 128 && bits.Words().Size() == 3 && bits.Words()[2] == 1);
+        bits.Resize(10);
+        assert(bits.Count() == 10 && bits.Words().Size() == 1);
+        bits.Resize(200, true);
+        assert(bits.Count() == 200);
+        bits.Resize(70);
+        bits.PopBack();
+        assert(bits.Size() == 69 && bits.Count() == 69 && bits.Words()[1] == 0x1f);
+
+        BitVector<> a{ true, false, true, true };
+        BitVector<> b{ false, false, true, true };
+        a.PushBack(true);
+        b.PushBack(false);
+        BitVector<> both = a;
+        both &= b;
+        assert(both == BitVector<>({ false, false, true, true, false }));
+        a ^= b;
+        assert(a != both && a.Count() == 2 && a.FindFirst() == 0 && a.FindNext(1) == 4);
+        a |= b;
+        std::vector<size_t> set;
+        a.ForEachSet([&set](size_t index) { set.push_back(index); });
+        assert((set == std::vector<size_t>{ 0, 2, 3, 4 }));
+        a[1] = a[0];
+        assert(a.Count() == 5);
+    }
+    {
+        PackedIntVector<3> v;
+        static_assert(PackedIntVector<3>::kValuesPerWord == 21 && PackedIntVector<3>::kMaxValue == 7);
+        for (size_t i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<uint8_t>(i % 8));
+        }
+        assert(v.Size() == 100 && v.Words().Size() == 5);
+        bool ok = true;
+        for (size_t i = 0; i < 100; ++i) {
+            ok = ok && v[i] == i % 8;
+        }
+        assert(ok);
+        v[50] = 0;
+        v.Set(51, 7);
+        assert(v[50] == 0 && v[51] == 7 && v[49] == 49 % 8 && v[52] == 52 % 8);
+        v.Resize(22);
+        assert(v.Words()[1] == 21 % 8);
+        v.Resize(64, 5);
+        assert(v[21] == 21 % 8 && v[22] == 5 && v[63] == 5);
+        v.PopBack();
+        assert(v.Size() == 63 && v.Words().Size() == 3);
+
+        PackedIntVector<12> wide{ 4095, 0, 1000 };
+        PackedIntVector<12> copy = wide;
+        assert(copy == wide && copy.Get(0) == 4095 && copy[2] == 1000);
+        copy.Reserve(100);
+        assert(copy.Capacity() >= 100 && copy == wide);
+
+        PackedIntVector<64> full(3, 1);
+        full[1] = std::numeric_limits<uint64_t>::max();
+        assert(full[0] == 1 && full[1] == std::numeric_limits<uint64_t>::max() && full.Words().Size() == 3);
+    }
+}
+
+struct CopyOnlyCountdown {
+    explicit CopyOnlyCountdown(int id)
+        : id(id) {
+        ++alive;
+    }
+    CopyOnlyCountdown(const CopyOnlyCountdown& other)
+        : id(other.id) {
+        if (copy_countdown > 0 && --copy_countdown == 0) {
+            throw std::runtime_error("copy");
+        }
+        ++alive;
+    }
+    CopyOnlyCountdown& operator=(const CopyOnlyCountdown& other) = default;
+    ~CopyOnlyCountdown() {
+        --alive;
+    }
+
+    int id;
+    static inline int alive = 0;
+    static inline int copy_countdown = 0;
+};
+
+template <typename SearchPolicy>
+void TestFlatContainers() {
+    using Set = FlatSet<int, std::less<int>, std::allocator<int>, SearchPolicy>;
+    using Map = FlatMap<int, std::string, std::less<int>, std::allocator<int>, std::allocator<std::string>, SearchPolicy>;
+    {
+        Set set{ 5, 1, 3, 1 };
+        assert(set.Size() == 3 && *set.begin() == 1 && set.Contains(3) && !set.Contains(2));
+        assert(set.LowerBound(0) == 0 && set.LowerBound(2) == 1 && set.LowerBound(6) == 3);
+        assert(set.Insert(2).second && !set.Insert(2).second && set.Size() == 4);
+        assert(set.Erase(3) == 1 && set.Erase(3) == 0 && set.Find(3) == set.end());
+        const int sorted[] = { 0, 2, 4, 6, 8 };
+        set.InsertSorted(std::begin(sorted), std::end(sorted));
+        assert(set == Set({ 0, 1, 2, 4, 5, 6, 8 }));
+        const int tail[] = { 9, 9, 10 };
+        set.Reserve(20);
+        set.InsertSorted(std::begin(tail), std::end(tail));
+        assert(set.Size() == 9 && set.Keys()[8] == 10 && set.Capacity() >= 20);
+        set.Clear();
+        assert(set.Empty() && set.Find(1) == set.end());
+
+        std::set<int> expected;
+        unsigned seed = 1;
+        for (int i = 0; i < 2000; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            const int key = static_cast<int>(seed >> 16) % 500;
+            if (seed & 0x100) {
+                set.Erase(key);
+                expected.erase(key);
+            }
+            else {
+                set.Insert(key);
+                expected.insert(key);
+            }
+        }
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+        bool found = true;
+        for (int key = -1; key <= 501; ++key) {
+            const size_t index = static_cast<size_t>(std::distance(expected.begin(), expected.lower_bound(key)));
+            found = found && set.LowerBound(key) == index && set.Contains(key) == (expected.count(key) == 1);
+        }
+        assert(found);
+    }
+    {
+        Map map{ { 3, "c" }, { 1, "a" }, { 3, "x" } };
+        assert(map.Size() == 2 && map.At(3) == "c" && map.Find(2) == nullptr);
+        map[2] = "b";
+        assert(map.Size() == 3 && *map.Find(2) == "b");
+        assert(!map.Insert(1, "z").second && map.At(1) == "a");
+        assert(!map.InsertOrAssign(1, "z").second && map.At(1) == "z");
+        try {
+            map.At(4);
+            assert(false);
+        }
+        catch (const std::out_of_range&) {
+        }
+        std::vector<std::pair<int, std::string>> items{ { 0, "zero" }, { 2, "two" }, { 5, "five" } };
+        map.InsertSorted(items.begin(), items.end());
+        assert(map.Size() == 5 && map.At(2) == "b" && map.At(5) == "five");
+        std::string joined;
+        for (auto [key, value] : map) {
+            joined += std::to_string(key) + value;
+            value += "!";
+        }
+        assert(joined == "0zero1z2b3c5five" && map.Values()[0] == "zero!");
+        assert(map.Erase(0) == 1 && map.Keys()[0] == 1 && map.begin().GetValue() == "z!");
+
+        std::map<int, std::string> expected(map.begin(), map.end());
+        for (int i = 0; i < 300; ++i) {
+            const int key = (i * 37) % 101;
+            if (i % 3 == 0) {
+                map.Erase(key);
+                expected.erase(key);
+            }
+            else {
+                map.TryEmplace(key, 3, 'a' + static_cast<char>(i % 26));
+                expected.emplace(key, std::string(3, 'a' + static_cast<char>(i % 26)));
+            }
+        }
+        const std::map<int, std::string> actual(map.cbegin(), map.cend());
+        assert(actual == expected);
+    }    {
+        // Значение копируется с исключением посреди слияния: ключи не должны быть перемещены раньше
+        using CountdownMap = FlatMap<std::string, CopyOnlyCountdown, std::less<std::string>, std::allocator<std::string>,
+                                     std::allocator<CopyOnlyCountdown>, SearchPolicy>;
+        CountdownMap map;
+        for (const char* key : { "b", "d", "f", "h" }) {
+            map.TryEmplace(key, key[0]);
+        }
+        const std::pair<std::string, CopyOnlyCountdown> items[] = { { "a", CopyOnlyCountdown('a') },
+                                                                     { "e", CopyOnlyCountdown('e') } };
+        for (int countdown = 1;; ++countdown) {
+            CopyOnlyCountdown::copy_countdown = countdown;
+            try {
+                map.InsertSorted(std::begin(items), std::end(items));
+                break;
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(map.Size() == 4 && map.Keys()[0] == "b" && map.Find("b") != nullptr && map.At("h").id == 'h');
+        }
+        CopyOnlyCountdown::copy_countdown = 0;
+        assert(map.Size() == 6 && map.Keys()[0] == "a" && map.At("e").id == 'e' && map.At("f").id == 'f');
+    }
+    assert(CopyOnlyCountdown::alive == 0);
+}
+
+void Test32() {
+    TestFlatContainers<BranchlessSearch>();
+    TestFlatContainers<EytzingerSearch>();
+    {
+        // Ключи из move_iterator перемещаются, поэтому подходят и некопируемые ключи
+        auto by_value = [](const std::unique_ptr<int>& lhs, const std::unique_ptr<int>& rhs) {
+            return *lhs < *rhs;
+        };
+        FlatSet<std::unique_ptr<int>, decltype(by_value)> set(by_value);
+        std::vector<std::unique_ptr<int>> keys;
+        for (int key : { 4, 1, 3 }) {
+            keys.push_back(std::make_unique<int>(key));
+        }
+        set.Insert(std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+        keys.clear();
+        keys.push_back(std::make_unique<int>(2));
+        keys.push_back(std::make_unique<int>(5));
+        set.InsertSorted(std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+        assert(set.Size() == 5 && **set.begin() == 1 && *set.Keys()[1] == 2 && *set.Keys()[4] == 5);
+        assert(keys[0] == nullptr && keys[1] == nullptr);
+    }
+}
+
+// Тип без перемещения, копирование которого бросает исключение на заданной по счёту копии
+
+void Test33() {
+    {
+        // Копии, сделанные до исключения при росте, разрушаются, а вектор не меняется
+        Vector<CopyOnlyCountdown> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i);
+        }
+        for (int countdown = 1; countdown <= 4; ++countdown) {
+            CopyOnlyCountdown::copy_countdown = countdown;
+            try {
+                v.Emplace(v.cbegin() + 2, 10);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 4 && v.Capacity() == 4 && v[1].id == 1 && v[2].id == 2);
+            assert(CopyOnlyCountdown::alive == 4);
+        }
+        CopyOnlyCountdown::copy_countdown = 0;
+        v.Emplace(v.cbegin() + 2, 10);
+        assert(v.Size() == 5 && v[2].id == 10 && v[4].id == 3 && CopyOnlyCountdown::alive == 5);
+        v.Emplace(v.cbegin() + 1, 11);
+        assert(v.Size() == 6 && v[1].id == 11 && v[3].id == 10 && CopyOnlyCountdown::alive == 6);
+    }
+    assert(CopyOnlyCountdown::alive == 0);
+    {
+        // Исключение при создании элемента в середине возвращает сдвинутый хвост на место
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(8);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i);
+        }
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.Emplace(v.cbegin() + 1);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v[0].id == 0 && v[1].id == 1 && v[3].id == 3);
+        assert(Obj::GetAliveObjectCount() == 4);
+
+        Obj throwing(7);
+        throwing.throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin(), 2, throwing);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v[0].id == 0 && v[3].id == 3);
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    {
+        // Аргументы, ссылающиеся на сдвигаемые элементы, читаются до сдвига
+        Vector<std::string> v{ "a", "b", std::string(40, 'c') };
+        v.Reserve(8);
+        v.Insert(v.cbegin(), v[2]);
+        v.Emplace(v.cbegin() + 1, v[3]);
+        v.Emplace(v.cbegin(), v[4], 0, 5);
+        assert(v.Size() == 6 && v[0] == "ccccc" && v[1] == std::string(40, 'c') && v[2] == std::string(40, 'c'));
+        assert(v[3] == "a" && v[5] == std::string(40, 'c'));
+        Vector<int, MallocAllocator<int>> ints{ 1, 2 };
+        ints.ShrinkToFit();
+        ints.Insert(ints.cbegin(), ints[1]);
+        assert(ints.Size() == 3 && ints[0] == 2 && ints[2] == 2);
+    }
+}
+
+// Политики проверок, сообщающие о нарушении исключением, чтобы тест мог его перехватить
+struct ThrowingBoundsChecks : HardenedVectorChecks {
+    [[noreturn]] static void Fail(const char* message) {
+        throw std::logic_error(message);
+    }
+};
+
+struct ThrowingIteratorChecks : CheckedVectorIterators {
+    [[noreturn]] static void Fail(const char* message) {
+        throw std::logic_error(message);
+    }
+};
+
+template <typename Action>
+bool FailsCheck(Action action) {
+    try {
+        action();
+    }
+    catch (const std::logic_error&) {
+        return true;
+    }
+    return false;
+}
+
+void Test34() {
+    static_assert(sizeof(Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats, HardenedVectorChecks>)
+                  == sizeof(Vector<int>));
+    static_assert(std::is_same_v<Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats,
+                                        HardenedVectorChecks>::iterator, int*>);
+    static_assert(noexcept(std::declval<Vector<int>&>()[0]));
+    static_assert(!noexcept(std::declval<Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats,
+                                                ThrowingBoundsChecks>&>()[0]));
+    {
+        using Checked = Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats, ThrowingBoundsChecks>;
+        Checked v{ 1, 2, 3 };
+        assert(FailsCheck([&v] { return v[3]; }));
+        assert(FailsCheck([&v] { v.Erase(v.end()); }));
+        assert(FailsCheck([&v] { v.Insert(v.begin() + 4, 0); }));
+        assert(FailsCheck([&v] { v.Erase(v.begin() + 2, v.begin() + 1); }));
+        Checked other{ 4 };
+        assert(FailsCheck([&v, &other] { v.Insert(other.begin(), 0); }));
+        assert(v.Size() == 3 && v[2] == 3);
+        v.Clear();
+        assert(FailsCheck([&v] { v.PopBack(); }));
+
+        StaticVector<int, 2, NoVectorStats, ThrowingBoundsChecks> fixed{ 1 };
+        assert(FailsCheck([&fixed] { return fixed[1]; }));
+    }
+    {
+        using Checked = Vector<std::string, std::allocator<std::string>, DoublingGrowth, NoVectorStats,
+                               ThrowingIteratorChecks>;
+        Checked v{ "c", "a", "b" };
+        v.Reserve(4);
+        auto it = v.begin() + 1;
+        v.PushBack("d");
+        assert(*it == "a");  // ёмкости хватило: итератор действителен
+        v.PushBack("e");
+        assert(FailsCheck([&it] { return *it; }));
+        assert(FailsCheck([&v, &it] { v.Erase(it); }));
+
+        auto last = v.end() - 1;
+        v.Erase(v.begin());
+        assert(FailsCheck([&last] { return *last; }));  // за концом после удаления
+        assert(FailsCheck([&v] { return v.end() + 1; }));
+        assert(FailsCheck([&v] { return *v.end(); }));
+
+        Checked other{ "x" };
+        assert(FailsCheck([&v, &other] { return v.begin() == other.begin(); }));
+        assert(FailsCheck([&v, &other] { v.Insert(other.cbegin(), "y"); }));
+
+        auto before_reserve = v.cbegin();
+        v.Reserve(v.Capacity() * 2);
+        assert(FailsCheck([&before_reserve] { return before_reserve[0]; }));
+
+        Checked::const_iterator first = v.begin();
+        std::sort(v.begin(), v.end());
+        assert(first == v.cbegin() && *first == "a" && v[3] == "e");
+        assert(std::find(v.cbegin(), v.cend(), "d") - v.cbegin() == 2);
+        assert(EraseIf(v, [](const std::string& s) { return s == "b"; }) == 1);
+
+        auto moved_from = v.begin();
+        Checked moved(std::move(v));
+        assert(FailsCheck([&moved_from] { return *moved_from; }));
+        assert(moved.Size() == 3 && *moved.begin() == "a");
+
+        SmallVector<int, 2, std::allocator<int>, DoublingGrowth, NoVectorStats, ThrowingIteratorChecks> small{ 1, 2 };
+        auto inline_it = small.begin();
+        small.PushBack(3);
+        assert(FailsCheck([&inline_it] { return *inline_it; }));
+        StaticVector<int, 4, NoVectorStats, ThrowingIteratorChecks> fixed{ 3, 1, 2 };
+        std::sort(fixed.begin(), fixed.end());
+        assert(fixed[0] == 1 && fixed[2] == 3);
+    }
+}
+
+// Неиспользуемая ёмкость вектора недоступна для ASan: [size, capacity) помечена, [0, size) — нет
+template <typename T>
+void AssertAnnotated(const T* data, size_t size, size_t capacity) {
+#if defined(VECTOR_ASAN_ANNOTATIONS)
+    if (capacity != 0) {
+        assert(__sanitizer_verify_contiguous_container(data, data + size, data + capacity));
+    }
+#else
+    static_cast<void>(data);
+    static_cast<void>(size);
+    static_cast<void>(capacity);
+#endif
+}
+
+// Случайная последовательность операций над вектором Obj сверяется с std::vector идентификаторов.
+// Часть операций прерывается исключением из конструктора Obj или из-за нехватки ёмкости:
+// у Obj перемещение не бросает, поэтому вектор должен остаться прежним, а живых Obj
+// всегда столько же, сколько элементов
+template <typename VectorType, bool kAnnotated>
+void StressAgainstStdVector(unsigned seed, int steps) {
+    Obj::ResetCounters();
+    std::mt19937 random(seed);
+    {
+        VectorType v;
+        std::vector<int> expected;
+        int next_id = 1;
+        for (int step = 0; step < steps; ++step) {
+            const size_t pos = random() % (expected.size() + 1);
+            const bool fail = random() % 6 == 0;
+            std::vector<int> next = expected;
+            try {
+                switch (random() % 11) {
+                case 0:
+                    v.PushBack(Obj(next_id));
+                    next.push_back(next_id++);
+                    break;
+                case 1:
+                    if (fail) {
+                        Obj::default_construction_throw_countdown = 1;
+                        v.Emplace(v.cbegin() + pos);
+                    }
+                    v.Emplace(v.cbegin() + pos, next_id);
+                    next.insert(next.begin() + pos, next_id++);
+                    break;
+                case 2: {
+                    Obj value(next_id);
+                    value.throw_on_copy = fail;
+                    const size_t count = random() % 5;
+                    v.Insert(v.cbegin() + pos, count, value);
+                    next.insert(next.begin() + pos, count, next_id++);
+                    break;
+                }
+                case 3: {
+                    std::vector<Obj> source;
+                    for (size_t i = random() % 6; i > 0; --i) {
+                        source.emplace_back(next_id);
+                        next.insert(next.begin() + pos + source.size() - 1, next_id++);
+                    }
+                    if (fail && !source.empty()) {
+                        source[random() % source.size()].throw_on_copy = true;
+                    }
+                    v.Insert(v.cbegin() + pos, source.begin(), source.end());
+                    break;
+                }
+                case 4: {
+                    const size_t size = random() % (expected.size() + 8);
+                    if (fail && size > expected.size()) {
+                        Obj::default_construction_throw_countdown = 1 + static_cast<int>(random() % (size - expected.size()));
+                    }
+                    v.Resize(size);
+                    next.resize(size, 0);
+                    break;
+                }
+                case 5:
+                    if (!next.empty()) {
+                        const size_t index = random() % next.size();
+                        v.Erase(v.cbegin() + index);
+                        next.erase(next.begin() + index);
+                    }
+                    break;
+                case 6: {
+                    const size_t last = pos + random() % (next.size() - pos + 1);
+                    v.Erase(v.cbegin() + pos, v.cbegin() + last);
+                    next.erase(next.begin() + pos, next.begin() + last);
+                    break;
+                }
+                case 7:
+                    if (!next.empty()) {
+                        const size_t index = random() % next.size();
+                        v.SwapErase(v.cbegin() + index);
+                        next[index] = next.back();
+                        next.pop_back();
+                    }
+                    break;
+                case 8:
+                    if (!next.empty()) {
+                        v.PopBack();
+                        next.pop_back();
+                    }
+                    break;
+                case 9:
+                    v.Reserve(v.Capacity() + random() % 16);
+                    break;
+                default:
+                    if (fail) {
+                        v.Clear();
+                        next.clear();
+                    }
+                    else {
+                        v.ShrinkToFit();
+                    }
+                    break;
+                }
+                expected = std::move(next);
+            }
+            catch (const std::exception&) {
+            }
+            Obj::default_construction_throw_countdown = 0;
+
+            assert(v.Size() == expected.size() && v.Capacity() >= v.Size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                assert(v[i].id == expected[i]);
+            }
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size()));
+            if constexpr (kAnnotated) {
+                AssertAnnotated(v.View().Data(), v.Size(), v.Capacity());
+            }
+        }
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test35() {
+    {
+        Vector<int> v;
+        v.Reserve(16);
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
+        }
+        AssertAnnotated(v.View().Data(), v.Size(), v.Capacity());
+        v.Erase(v.cbegin() + 1, v.cbegin() + 3);
+        v.Insert(v.cbegin(), { 7, 8, 9 });
+        AssertAnnotated(v.View().Data(), v.Size(), v.Capacity());
+        v.Resize(20);
+        v.Resize(2);
+        AssertAnnotated(v.View().Data(), v.Size(), v.Capacity());
+
+        Vector<int> copy(v, 10);
+        AssertAnnotated(copy.View().Data(), copy.Size(), copy.Capacity());
+        v.Swap(copy);
+        AssertAnnotated(v.View().Data(), v.Size(), v.Capacity());
+
+        // Отданный буфер размечен только пока принадлежит вектору
+        auto buffer = v.Release();
+        Vector<int> adopted = Vector<int>::Adopt(std::move(buffer));
+        assert(adopted.Size() == 2 && adopted[0] == 7);
+        AssertAnnotated(adopted.View().Data(), adopted.Size(), adopted.Capacity());
+
+        Vector<int, MallocAllocator<int>> grown;
+        for (int i = 0; i < 100; ++i) {
+            grown.PushBack(i);
+        }
+        AssertAnnotated(grown.View().Data(), grown.Size(), grown.Capacity());
+        grown.Resize(3);
+        grown.ShrinkToFit();
+        AssertAnnotated(grown.View().Data(), grown.Size(), grown.Capacity());
+
+        SmallVector<int, 2> small{ 1, 2, 3 };
+        small.Reserve(8);
+        assert(!small.IsInline());
+        AssertAnnotated(small.View().Data(), small.Size(), small.Capacity());
+    }
+    {
+        SoAVector<int, std::string> rows;
+        rows.Reserve(8);
+        for (int i = 0; i < 3; ++i) {
+            rows.EmplaceBack(i, "row");
+        }
+        AssertAnnotated(rows.Column<0>().Data(), rows.Size(), rows.Capacity());
+        AssertAnnotated(rows.Column<1>().Data(), rows.Size(), rows.Capacity());
+        for (int i = 3; i < 11; ++i) {
+            rows.EmplaceBack(i, "row");
+        }
+        rows.PopBack();
+        AssertAnnotated(rows.Column<0>().Data(), rows.Size(), rows.Capacity());
+        AssertAnnotated(rows.Column<1>().Data(), rows.Size(), rows.Capacity());
+        rows.Resize(12);
+        rows.Resize(4);
+        SoAVector<int, std::string> copy = rows;
+        rows.Clear();
+        AssertAnnotated(rows.Column<1>().Data(), 0, rows.Capacity());
+        AssertAnnotated(copy.Column<1>().Data(), copy.Size(), copy.Capacity());
+    }
+    {
+        // Каждый сегмент размечается отдельно: сегмент 0 заполнен, в сегменте 1 живы 4 ячейки из 32
+        SegmentedVector<int> segmented;
+        for (int i = 0; i < 20; ++i) {
+            segmented.PushBack(i);
         }
-        Dump();
+        const int* second = &segmented[16];
+        AssertAnnotated(&segmented[0], 16, 16);
+        AssertAnnotated(second, 4, 32);
+        segmented.Resize(14);
+        AssertAnnotated(&segmented[0], 14, 16);
+        AssertAnnotated(second, 0, 32);
+        SegmentedVector<int> copy(segmented);
+        copy.Reserve(100);
+        AssertAnnotated(&copy[0], 14, 16);
+        segmented.Resize(60);
+        AssertAnnotated(second, 32, 32);
+        segmented.Clear();
+        segmented.ShrinkToFit();
+        assert(segmented.Capacity() == 0);
     }
-    catch (...) {
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        StressAgainstStdVector<Vector<Obj>, true>(seed, 300);
+        StressAgainstStdVector<Vector<Obj, std::allocator<Obj>, DoublingGrowth, NoVectorStats, CheckedVectorIterators>,
+                               true>(seed, 300);
+        StressAgainstStdVector<SmallVector<Obj, 4>, false>(seed, 300);
+        StressAgainstStdVector<StaticVector<Obj, 24>, false>(seed, 300);
     }
 }
 
@@ -654,7 +2693,35 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
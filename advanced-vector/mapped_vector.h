@@ -0,0 +1,355 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#error "mapped_vector.h requires a POSIX system (mmap)"
+#endif
+
+// Способы открытия файла MappedVector
+enum class MappedOpenMode {
+    kCreate,        // создать новый файл или очистить существующий
+    kOpen,          // открыть существующий файл, сохранив его содержимое
+    kOpenOrCreate,  // открыть файл, если он существует, иначе создать
+};
+
+// Подсказки ядру о предстоящем характере доступа к элементам (madvise)
+enum class MappedAdvice {
+    kNormal,
+    kSequential,
+    kRandom,
+    kWillNeed,
+    kDontNeed,
+};
+
+// Файл, отображаемый в память целиком. В начале файла лежит заголовок с размером элемента
+// и числом элементов, за ним — сами элементы. Длина файла определяет ёмкость вектора.
+// Одновременно существует не больше одного отображения файла
+class MappedFile {
+public:
+    // Заголовок занимает 64 байта, поэтому элементы с выравниванием до 64 байт выровнены в отображении
+    static constexpr size_t kHeaderSize = 64;
+
+    MappedFile(const std::string& path, MappedOpenMode mode) {
+        int flags = O_RDWR | O_CLOEXEC;
+        if (mode == MappedOpenMode::kCreate) {
+            flags |= O_CREAT | O_TRUNC;
+        }
+        else if (mode == MappedOpenMode::kOpenOrCreate) {
+            flags |= O_CREAT;
+        }
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ == -1) {
+            ThrowLastError("open");
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_bytes_);
+        }
+        ::close(fd_);
+    }
+
+    // Читает заголовок. Возвращает false, если файл пуст или не является файлом MappedVector
+    bool ReadHeader(uint64_t& element_size, uint64_t& size) const {
+        Header header;
+        const ssize_t bytes = ::pread(fd_, &header, sizeof(header), 0);
+        if (bytes == -1) {
+            ThrowLastError("pread");
+        }
+        if (static_cast<size_t>(bytes) != sizeof(header) || header.magic != kMagic) {
+            return false;
+        }
+        element_size = header.element_size;
+        size = header.size;
+        return true;
+    }
+
+    void WriteHeader(uint64_t element_size, uint64_t size) {
+        const Header header{ kMagic, element_size, size };
+        if (::pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            ThrowLastError("pwrite");
+        }
+    }
+
+    // Число байт, доступных под элементы
+    size_t DataBytes() const {
+        struct stat st;
+        if (::fstat(fd_, &st) == -1) {
+            ThrowLastError("fstat");
+        }
+        const size_t length = static_cast<size_t>(st.st_size);
+        return length > kHeaderSize ? length - kHeaderSize : 0;
+    }
+
+    bool IsMapped() const noexcept {
+        return base_ != nullptr;
+    }
+
+    // Устанавливает длину файла под data_bytes байт элементов и отображает его.
+    // Данные, уже записанные в файл, сохраняются
+    void* Map(size_t data_bytes) {
+        assert(!IsMapped());
+        const size_t length = kHeaderSize + data_bytes;
+        Truncate(length);
+        void* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        base_ = static_cast<unsigned char*>(base);
+        mapped_bytes_ = length;
+        return base_ + kHeaderSize;
+    }
+
+    // Изменяет длину файла и отображения. Содержимое сохраняется, так как оно хранится в файле
+    void* Remap(size_t data_bytes) {
+        assert(IsMapped());
+        const size_t length = kHeaderSize + data_bytes;
+        const size_t old_length = mapped_bytes_;
+        if (length > old_length) {
+            Truncate(length);
+        }
+#if defined(__linux__)
+        void* base = ::mremap(base_, mapped_bytes_, length, MREMAP_MAYMOVE);
+        if (base == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#else
+        void* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        ::munmap(base_, old_length);
+#endif
+        base_ = static_cast<unsigned char*>(base);
+        mapped_bytes_ = length;
+        if (length < old_length) {
+            Truncate(length);
+        }
+        return base_ + kHeaderSize;
+    }
+
+    void Unmap() noexcept {
+        assert(IsMapped());
+        ::munmap(base_, mapped_bytes_);
+        base_ = nullptr;
+        mapped_bytes_ = 0;
+    }
+
+    // Записывает изменённые страницы отображения и заголовок на диск
+    void Sync() {
+        if (base_ != nullptr && ::msync(base_, mapped_bytes_, MS_SYNC) == -1) {
+            ThrowLastError("msync");
+        }
+        if (::fsync(fd_) == -1) {
+            ThrowLastError("fsync");
+        }
+    }
+
+    void Advise(MappedAdvice advice) {
+        if (base_ == nullptr) {
+            return;
+        }
+        if (::posix_madvise(base_, mapped_bytes_, ToPosixAdvice(advice)) != 0) {
+            ThrowLastError("posix_madvise");
+        }
+    }
+
+private:
+    struct Header {
+        uint64_t magic;
+        uint64_t element_size;
+        uint64_t size;
+    };
+    static_assert(sizeof(Header) <= kHeaderSize);
+
+    static constexpr uint64_t kMagic = 0x31504D4345564441;  // "ADVECMP1"
+
+    static int ToPosixAdvice(MappedAdvice advice) noexcept {
+        switch (advice) {
+            case MappedAdvice::kSequential:
+                return POSIX_MADV_SEQUENTIAL;
+            case MappedAdvice::kRandom:
+                return POSIX_MADV_RANDOM;
+            case MappedAdvice::kWillNeed:
+                return POSIX_MADV_WILLNEED;
+            case MappedAdvice::kDontNeed:
+                return POSIX_MADV_DONTNEED;
+            default:
+                return POSIX_MADV_NORMAL;
+        }
+    }
+
+    [[noreturn]] static void ThrowLastError(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void Truncate(size_t length) {
+        if (::ftruncate(fd_, static_cast<off_t>(length)) == -1) {
+            ThrowLastError("ftruncate");
+        }
+    }
+
+    int fd_ = -1;
+    unsigned char* base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+};
+
+// Аллокатор, выдающий память из отображения файла. Поддерживает reallocate, поэтому
+// VectorBase растёт через ftruncate + mremap, не создавая второго буфера
+template <typename T>
+class MappedFileAllocator {
+    template <typename U>
+    friend class MappedFileAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    explicit MappedFileAllocator(std::shared_ptr<MappedFile> file) noexcept
+        : file_(std::move(file)) {
+    }
+
+    template <typename U>
+    MappedFileAllocator(const MappedFileAllocator<U>& other) noexcept
+        : file_(other.file_) {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(file_->Map(n * sizeof(T)));
+    }
+
+    T* reallocate(T*, size_t, size_t new_n) {
+        return static_cast<T*>(file_->Remap(new_n * sizeof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {
+        file_->Unmap();
+    }
+
+    MappedFile* GetFile() const noexcept {
+        return file_.get();
+    }
+
+    template <typename U>
+    bool operator==(const MappedFileAllocator<U>& rhs) const noexcept {
+        return file_ == rhs.file_;
+    }
+
+    template <typename U>
+    bool operator!=(const MappedFileAllocator<U>& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+
+private:
+    std::shared_ptr<MappedFile> file_;
+};
+
+// Вектор тривиально копируемых элементов, хранящий их в файле. Повторное открытие файла
+// не требует десериализации: файл отображается в память, и элементы сразу доступны.
+// Число элементов записывается в заголовок в Sync() и в деструкторе
+template <typename T, typename GrowthPolicy = DoublingGrowth, typename StatsPolicy = NoVectorStats>
+class MappedVector
+    : public VectorBase<T, RawMemory<T, MappedFileAllocator<T>>, GrowthPolicy, StatsPolicy> {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector requires a trivially copyable T");
+    static_assert(alignof(T) <= MappedFile::kHeaderSize, "MappedVector does not support such alignment");
+
+    using Allocator = MappedFileAllocator<T>;
+    using Base = VectorBase<T, RawMemory<T, Allocator>, GrowthPolicy, StatsPolicy>;
+    using Base::data_;
+    using Base::size_;
+
+public:
+    explicit MappedVector(const std::string& path, MappedOpenMode mode = MappedOpenMode::kOpenOrCreate)
+        : MappedVector(std::make_shared<MappedFile>(path, mode)) {
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    // Перемещённый вектор теряет связь с файлом и не перезаписывает его заголовок
+    MappedVector(MappedVector&& other) noexcept
+        : Base(std::in_place, std::move(other.data_))
+    {
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            MappedVector tmp(std::move(rhs));
+            data_.Swap(tmp.data_);
+            std::swap(size_, tmp.size_);
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        try {
+            WriteSize();
+        }
+        catch (...) {
+            // Деструктор не должен бросать; для гарантированной записи следует вызвать Sync()
+        }
+    }
+
+    // Сохраняет размер в заголовке и сбрасывает изменения на диск
+    void Sync() {
+        WriteSize();
+        data_.GetAllocator().GetFile()->Sync();
+    }
+
+    void Advise(MappedAdvice advice) {
+        data_.GetAllocator().GetFile()->Advise(advice);
+    }
+
+private:
+    explicit MappedVector(std::shared_ptr<MappedFile> file)
+        : Base(std::in_place, ExistingCapacity(*file), Allocator(file))
+    {
+        uint64_t element_size = 0;
+        uint64_t size = 0;
+        if (file->ReadHeader(element_size, size)) {
+            if (element_size != sizeof(T) || size > this->Capacity()) {
+                throw std::runtime_error("MappedVector: file does not match element type");
+            }
+            size_ = static_cast<size_t>(size);
+        }
+        else {
+            if (this->Capacity() != 0) {
+                throw std::runtime_error("MappedVector: file is not a MappedVector file");
+            }
+            file->WriteHeader(sizeof(T), 0);
+        }
+    }
+
+    // Ёмкость, которую занимают элементы в уже существующем файле
+    static size_t ExistingCapacity(const MappedFile& file) {
+        uint64_t element_size = 0;
+        uint64_t size = 0;
+        if (!file.ReadHeader(element_size, size) || element_size != sizeof(T)) {
+            return 0;
+        }
+        return file.DataBytes() / sizeof(T);
+    }
+
+    void WriteSize() {
+        if (MappedFile* file = data_.GetAllocator().GetFile()) {
+            file->WriteHeader(sizeof(T), size_);
+        }
+    }
+};
@@ -0,0 +1,276 @@
+#pragma once
+#include "small_vector.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <memory_resource>
+
+// Монотонная арена: память выдаётся сдвигом указателя внутри блоков, полученных от upstream,
+// а освобождение отдельных выделений ничего не делает. Вся память арены освобождается разом
+// в Reset() или Release(), поэтому векторы, живущие не дольше арены, не платят за operator delete.
+// Каждый следующий блок вдвое больше предыдущего. Не потокобезопасна
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    explicit MonotonicArena(size_t initial_block_bytes = 4096,
+                            std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : upstream_(upstream)
+        , next_block_bytes_(std::max(initial_block_bytes, kMinBlockBytes)) {
+    }
+
+    // Сначала используется внешний буфер (например, на стеке), затем — блоки upstream
+    MonotonicArena(void* buffer, size_t buffer_bytes,
+                   std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : upstream_(upstream)
+        , current_(static_cast<unsigned char*>(buffer))
+        , end_(current_ + buffer_bytes)
+        , initial_buffer_(current_)
+        , next_block_bytes_(std::max(buffer_bytes * 2, kMinBlockBytes)) {
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() override {
+        Release();
+    }
+
+    // Делает всю память арены снова доступной. Последний (самый большой) блок сохраняется,
+    // остальные возвращаются upstream. Выделенные ранее указатели становятся недействительными
+    void Reset() noexcept {
+        if (blocks_ == nullptr) {
+            current_ = initial_buffer_;
+            return;
+        }
+        FreeBlocks(blocks_->next);
+        blocks_->next = nullptr;
+        current_ = reinterpret_cast<unsigned char*>(blocks_) + sizeof(BlockHeader);
+        end_ = reinterpret_cast<unsigned char*>(blocks_) + blocks_->bytes;
+        initial_buffer_ = nullptr;
+    }
+
+    // Возвращает upstream все блоки
+    void Release() noexcept {
+        FreeBlocks(blocks_);
+        blocks_ = nullptr;
+        current_ = end_ = initial_buffer_ = nullptr;
+    }
+
+    // Объём памяти, полученной от upstream
+    size_t UpstreamBytes() const noexcept {
+        size_t bytes = 0;
+        for (const BlockHeader* block = blocks_; block != nullptr; block = block->next) {
+            bytes += block->bytes;
+        }
+        return bytes;
+    }
+
+    std::pmr::memory_resource* GetUpstream() const noexcept {
+        return upstream_;
+    }
+
+private:
+    struct alignas(std::max_align_t) BlockHeader {
+        BlockHeader* next;
+        size_t bytes;
+    };
+
+    static constexpr size_t kMinBlockBytes = 256;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (void* p = TryAllocate(bytes, alignment)) {
+            return p;
+        }
+        if (bytes > std::numeric_limits<size_t>::max() - alignment) {
+            throw std::bad_alloc();
+        }
+        AddBlock(bytes + alignment);
+        return TryAllocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) noexcept override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void* TryAllocate(size_t bytes, size_t alignment) noexcept {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(current_);
+        const uintptr_t aligned = (address + alignment - 1) & ~(uintptr_t{ alignment } - 1);
+        if (current_ == nullptr || aligned < address || aligned - address > static_cast<size_t>(end_ - current_)
+            || bytes > static_cast<size_t>(end_ - current_) - (aligned - address)) {
+            return nullptr;
+        }
+        current_ += aligned - address + bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void AddBlock(size_t min_bytes) {
+        if (min_bytes > std::numeric_limits<size_t>::max() - sizeof(BlockHeader)) {
+            throw std::bad_alloc();
+        }
+        const size_t bytes = std::max(next_block_bytes_, min_bytes + sizeof(BlockHeader));
+        auto* block = static_cast<BlockHeader*>(upstream_->allocate(bytes, alignof(BlockHeader)));
+        block->next = blocks_;
+        block->bytes = bytes;
+        blocks_ = block;
+        current_ = reinterpret_cast<unsigned char*>(block) + sizeof(BlockHeader);
+        end_ = reinterpret_cast<unsigned char*>(block) + bytes;
+        if (next_block_bytes_ <= std::numeric_limits<size_t>::max() / 2) {
+            next_block_bytes_ *= 2;
+        }
+    }
+
+    void FreeBlocks(BlockHeader* block) noexcept {
+        while (block != nullptr) {
+            BlockHeader* next = block->next;
+            upstream_->deallocate(block, block->bytes, alignof(BlockHeader));
+            block = next;
+        }
+    }
+
+    std::pmr::memory_resource* upstream_;
+    BlockHeader* blocks_ = nullptr;
+    unsigned char* current_ = nullptr;
+    unsigned char* end_ = nullptr;
+    unsigned char* initial_buffer_ = nullptr;
+    size_t next_block_bytes_;
+};
+
+// Пул блоков по классам размеров. Запросы до kMaxPooledBytes байт округляются до степени двойки
+// и выдаются из списка свободных блоков своего класса; освобождённый блок возвращается в этот список
+// и переиспользуется без обращения к upstream. Блоки нарезаются из слэбов, полученных от upstream,
+// и выровнены по своему размеру. Большие запросы передаются upstream напрямую. Не потокобезопасен
+class SizeClassPool : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kMinPooledBytes = 16;
+    static constexpr size_t kMaxPooledBytes = 4096;
+
+    explicit SizeClassPool(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+                           size_t slab_bytes = size_t{ 64 } << 10) noexcept
+        : upstream_(upstream)
+        , slab_bytes_((std::max(slab_bytes, 2 * kMaxPooledBytes) + kMaxPooledBytes - 1) & ~(kMaxPooledBytes - 1)) {
+    }
+
+    SizeClassPool(const SizeClassPool&) = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    ~SizeClassPool() override {
+        Release();
+    }
+
+    // Возвращает upstream все слэбы. Выделенные из пула блоки становятся недействительными
+    void Release() noexcept {
+        while (slabs_ != nullptr) {
+            SlabHeader* next = slabs_->next;
+            upstream_->deallocate(SlabBegin(slabs_), slab_bytes_, kMaxPooledBytes);
+            slabs_ = next;
+        }
+        std::fill(std::begin(free_lists_), std::end(free_lists_), nullptr);
+        current_ = end_ = nullptr;
+    }
+
+    std::pmr::memory_resource* GetUpstream() const noexcept {
+        return upstream_;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Заголовок слэба лежит в его конце, а начало слэба выровнено по kMaxPooledBytes
+    struct SlabHeader {
+        SlabHeader* next;
+    };
+
+    static constexpr size_t kNumClasses = 9;  // 16, 32, ..., 4096
+    static_assert(kMinPooledBytes << (kNumClasses - 1) == kMaxPooledBytes);
+
+    static size_t ClassOf(size_t bytes) noexcept {
+        size_t size_class = 0;
+        while ((kMinPooledBytes << size_class) < bytes) {
+            ++size_class;
+        }
+        return size_class;
+    }
+
+    static size_t ClassBytes(size_t size_class) noexcept {
+        return kMinPooledBytes << size_class;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        const size_t request = std::max(bytes, alignment);
+        if (request > kMaxPooledBytes) {
+            return upstream_->allocate(bytes, alignment);
+        }
+        const size_t size_class = ClassOf(request);
+        if (FreeBlock* block = free_lists_[size_class]) {
+            free_lists_[size_class] = block->next;
+            return block;
+        }
+        return Carve(ClassBytes(size_class));
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) noexcept override {
+        const size_t request = std::max(bytes, alignment);
+        if (request > kMaxPooledBytes) {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        const size_t size_class = ClassOf(request);
+        auto* block = static_cast<FreeBlock*>(p);
+        block->next = free_lists_[size_class];
+        free_lists_[size_class] = block;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    // Отрезает от текущего слэба блок размера block_bytes, выровненный по этому размеру.
+    // Остаток слэба, который не вмещает блок, теряется до Release()
+    void* Carve(size_t block_bytes) {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(current_);
+        const uintptr_t aligned = (address + block_bytes - 1) & ~(uintptr_t{ block_bytes } - 1);
+        if (current_ == nullptr || aligned + block_bytes > reinterpret_cast<uintptr_t>(end_)) {
+            AddSlab();
+            current_ += block_bytes;
+            return current_ - block_bytes;
+        }
+        current_ = reinterpret_cast<unsigned char*>(aligned + block_bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void AddSlab() {
+        auto* slab = static_cast<unsigned char*>(upstream_->allocate(slab_bytes_, kMaxPooledBytes));
+        auto* header = reinterpret_cast<SlabHeader*>(slab + slab_bytes_ - sizeof(SlabHeader));
+        header->next = slabs_;
+        slabs_ = header;
+        current_ = slab;
+        end_ = reinterpret_cast<unsigned char*>(header);
+    }
+
+    unsigned char* SlabBegin(SlabHeader* header) const noexcept {
+        return reinterpret_cast<unsigned char*>(header) + sizeof(SlabHeader) - slab_bytes_;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t slab_bytes_;
+    FreeBlock* free_lists_[kNumClasses] = {};
+    SlabHeader* slabs_ = nullptr;
+    unsigned char* current_ = nullptr;
+    unsigned char* end_ = nullptr;
+};
+
+// Векторы, память которых выбирается во время выполнения через std::pmr::memory_resource.
+// Vector<std::pmr::string> передаёт свой ресурс и элементам (uses-allocator construction)
+namespace pmr {
+
+template <typename T, typename GrowthPolicy = DoublingGrowth, typename StatsPolicy = NoVectorStats>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, GrowthPolicy, StatsPolicy>;
+
+template <typename T, size_t N, typename GrowthPolicy = DoublingGrowth, typename StatsPolicy = NoVectorStats>
+using SmallVector = ::SmallVector<T, N, std::pmr::polymorphic_allocator<T>, GrowthPolicy, StatsPolicy>;
+
+}  // namespace pmr
@@ -0,0 +1,540 @@
+#pragma once
+#include "vector.h"
+
+#include <array>
+
+namespace detail {
+
+// Разбиение индексов на сегменты, размеры которых растут как степени двойки:
+// сегмент s вмещает FirstSegmentSize << s элементов и начинается с индекса
+// FirstSegmentSize * (2^s - 1). Номер сегмента вычисляется за O(1) через старший бит
+template <size_t FirstSegmentSize>
+struct SegmentLayout {
+    static_assert(FirstSegmentSize > 0 && (FirstSegmentSize & (FirstSegmentSize - 1)) == 0,
+                  "FirstSegmentSize must be a power of two");
+
+    static constexpr size_t kMaxSegments = std::numeric_limits<size_t>::digits;
+
+    static size_t FloorLog2(size_t value) noexcept {
+        assert(value != 0);
+#if defined(__GNUC__)
+        return std::numeric_limits<unsigned long long>::digits - 1 - __builtin_clzll(value);
+#else
+        size_t result = 0;
+        while (value >>= 1) {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    static size_t SegmentOf(size_t index) noexcept {
+        return FloorLog2(index / FirstSegmentSize + 1);
+    }
+
+    static size_t SegmentBegin(size_t segment) noexcept {
+        return FirstSegmentSize * ((size_t{1} << segment) - 1);
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return FirstSegmentSize << segment;
+    }
+};
+
+}  // namespace detail
+
+// Вектор, элементы которого хранятся в сегментах растущего размера и никогда не перемещаются
+// при росте. Добавление в конец выполняется за O(1) в худшем случае (выделяется не больше
+// одного сегмента), ссылки и итераторы на существующие элементы остаются действительными.
+// Элементы не лежат в памяти непрерывно, но доступ по индексу остаётся O(1).
+// Под ASan свободные ячейки сегментов недоступны, если аллокатор разрешает разметку
+template <typename T, typename Allocator = std::allocator<T>, size_t FirstSegmentSize = 16>
+class SegmentedVector : private Allocator {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Layout = detail::SegmentLayout<FirstSegmentSize>;
+    static constexpr bool kAnnotate = detail::AnnotatesContainer<RawMemory<T, Allocator>>::value;
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+            : owner_(other.owner_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return *(*this + offset);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        BasicIterator operator++(int) noexcept {
+            BasicIterator result = *this;
+            ++index_;
+            return result;
+        }
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        BasicIterator operator--(int) noexcept {
+            BasicIterator result = *this;
+            --index_;
+            return result;
+        }
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ > rhs.index_;
+        }
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <= rhs.index_;
+        }
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ >= rhs.index_;
+        }
+
+    private:
+        friend class SegmentedVector;
+        template <bool>
+        friend class BasicIterator;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator& alloc) noexcept
+        : Allocator(alloc) {
+    }
+
+    explicit SegmentedVector(size_t size, const Allocator& alloc = Allocator())
+        : Allocator(alloc)
+    {
+        try {
+            Resize(size);
+        }
+        catch (...) {
+            Release();
+            throw;
+        }
+    }
+
+    SegmentedVector(std::initializer_list<T> values, const Allocator& alloc = Allocator())
+        : Allocator(alloc)
+    {
+        try {
+            Reserve(values.size());
+            for (const T& value : values) {
+                EmplaceBack(value);
+            }
+        }
+        catch (...) {
+            Release();
+            throw;
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(other, AllocTraits::select_on_container_copy_construction(other.GetAlloc()))
+    {
+    }
+
+    SegmentedVector(const SegmentedVector& other, const Allocator& alloc)
+        : Allocator(alloc)
+    {
+        try {
+            CopySegmentsFrom(other);
+        }
+        catch (...) {
+            Release();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : Allocator(std::move(other.GetAlloc()))
+    {
+        StealSegments(other);
+    }
+
+    ~SegmentedVector() {
+        Release();
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            constexpr bool kPropagate = AllocTraits::propagate_on_container_copy_assignment::value;
+            SegmentedVector tmp(rhs, kPropagate ? rhs.GetAlloc() : GetAlloc());
+            SwapSegments(tmp);
+            if constexpr (kPropagate) {
+                using std::swap;
+                swap(GetAlloc(), tmp.GetAlloc());
+            }
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                Release();
+                GetAlloc() = std::move(rhs.GetAlloc());
+                StealSegments(rhs);
+            }
+            else {
+                if (AllocTraits::is_always_equal::value || GetAlloc() == rhs.GetAlloc()) {
+                    Release();
+                    StealSegments(rhs);
+                }
+                else {
+                    // Память rhs нельзя освободить нашим аллокатором, поэтому элементы перемещаются
+                    SegmentedVector tmp(GetAlloc());
+                    tmp.Reserve(rhs.size_);
+                    for (T& value : rhs) {
+                        tmp.EmplaceBack(std::move(value));
+                    }
+                    SwapSegments(tmp);
+                    rhs.Clear();
+                }
+            }
+        }
+        return *this;
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(GetAlloc(), other.GetAlloc());
+        }
+        else {
+            assert(AllocTraits::is_always_equal::value || GetAlloc() == other.GetAlloc());
+        }
+        SwapSegments(other);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator cend() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return Layout::SegmentBegin(num_segments_);
+    }
+
+    Allocator& GetAllocator() noexcept {
+        return GetAlloc();
+    }
+
+    // Выделяет сегменты, пока их суммарная вместимость меньше new_capacity. Элементы не переносятся
+    void Reserve(size_t new_capacity) {
+        while (Capacity() < new_capacity) {
+            AllocateSegment();
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyTail(size_ - new_size);
+            return;
+        }
+        Reserve(new_size);
+        const size_t old_size = size_;
+        try {
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+        }
+        catch (...) {
+            DestroyTail(size_ - old_size);
+            throw;
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Элементы не переезжают, поэтому args могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            AllocateSegment();
+        }
+        T* place = Slot(size_);
+        AnnotateSize(size_, size_ + 1);
+        try {
+            AllocTraits::construct(GetAlloc(), place, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            AnnotateSize(size_ + 1, size_);
+            throw;
+        }
+        ++size_;
+        return *place;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        DestroyTail(1);
+    }
+
+    void Clear() noexcept {
+        DestroyTail(size_);
+    }
+
+    // Освобождает сегменты, в которых не осталось элементов
+    void ShrinkToFit() noexcept {
+        while (num_segments_ > 0 && Layout::SegmentBegin(num_segments_ - 1) >= size_) {
+            --num_segments_;
+            AnnotateSegment(num_segments_, 0, Layout::SegmentSize(num_segments_));
+            AllocTraits::deallocate(GetAlloc(), segments_[num_segments_], Layout::SegmentSize(num_segments_));
+            segments_[num_segments_] = nullptr;
+        }
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos.index_;
+        if (index == size_) {
+            EmplaceBack(std::forward<Args>(args)...);
+        }
+        else {
+            T tmp(std::forward<Args>(args)...);
+            EmplaceBack(std::move((*this)[size_ - 1]));
+            std::move_backward(begin() + index, end() - 2, end() - 1);
+            (*this)[index] = std::move(tmp);
+        }
+        return begin() + index;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t index = first.index_;
+        const size_t count = last - first;
+        if (count != 0) {
+            std::move(begin() + last.index_, end(), begin() + index);
+            DestroyTail(count);
+        }
+        return begin() + index;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    // Вызывает action(data, count) для непрерывных участков элементов в порядке индексов
+    template <typename Action>
+    void ForEachChunk(Action action) {
+        for (size_t segment = 0; segment < num_segments_ && Layout::SegmentBegin(segment) < size_; ++segment) {
+            action(segments_[segment], std::min(Layout::SegmentSize(segment), size_ - Layout::SegmentBegin(segment)));
+        }
+    }
+
+private:
+    Allocator& GetAlloc() noexcept {
+        return static_cast<Allocator&>(*this);
+    }
+
+    const Allocator& GetAlloc() const noexcept {
+        return static_cast<const Allocator&>(*this);
+    }
+
+    // Адрес ячейки index в выделенных сегментах; элемента в ней может ещё не быть
+    T* Slot(size_t index) noexcept {
+        assert(index < Capacity());
+        const size_t segment = Layout::SegmentOf(index);
+        return segments_[segment] + (index - Layout::SegmentBegin(segment));
+    }
+
+    void AllocateSegment() {
+        assert(num_segments_ < Layout::kMaxSegments);
+        segments_[num_segments_] = AllocTraits::allocate(GetAlloc(), Layout::SegmentSize(num_segments_));
+        // Новый сегмент лежит за последним элементом
+        AnnotateSegment(num_segments_, Layout::SegmentSize(num_segments_), 0);
+        ++num_segments_;
+    }
+
+    // Под ASan в сегменте живы первые new_count ячеек вместо old_count
+    void AnnotateSegment(size_t segment, size_t old_count, size_t new_count) noexcept {
+        if constexpr (kAnnotate) {
+            detail::AnnotateContainer(segments_[segment], Layout::SegmentSize(segment), old_count, new_count);
+        }
+        else {
+            static_cast<void>(segment);
+            static_cast<void>(old_count);
+            static_cast<void>(new_count);
+        }
+    }
+
+    // Переразмечает сегменты, в которых число элементов меняется с old_size на new_size
+    void AnnotateSize(size_t old_size, size_t new_size) noexcept {
+        if constexpr (kAnnotate) {
+            const size_t last = std::max(old_size, new_size);
+            for (size_t segment = Layout::SegmentOf(std::min(old_size, new_size));
+                 segment < num_segments_ && Layout::SegmentBegin(segment) < last; ++segment) {
+                const size_t begin = Layout::SegmentBegin(segment);
+                const size_t segment_size = Layout::SegmentSize(segment);
+                const auto count = [begin, segment_size](size_t size) {
+                    return size > begin ? std::min(size - begin, segment_size) : 0;
+                };
+                AnnotateSegment(segment, count(old_size), count(new_size));
+            }
+        }
+        else {
+            static_cast<void>(old_size);
+            static_cast<void>(new_size);
+        }
+    }
+
+    // Разрушает count последних элементов, сегменты остаются выделенными
+    void DestroyTail(size_t count) noexcept {
+        assert(count <= size_);
+        const size_t old_size = size_;
+        for (; count > 0; --count) {
+            AllocTraits::destroy(GetAlloc(), Slot(--size_));
+        }
+        AnnotateSize(old_size, size_);
+    }
+
+    // Разрушает элементы и освобождает все сегменты
+    void Release() noexcept {
+        Clear();
+        ShrinkToFit();
+    }
+
+    // Копирует элементы other посегментно: раскладка по сегментам у обоих векторов одинакова
+    void CopySegmentsFrom(const SegmentedVector& other) {
+        assert(size_ == 0);
+        Reserve(other.size_);
+        const_cast<SegmentedVector&>(other).ForEachChunk([this](const T* data, size_t count) {
+            AnnotateSize(size_, size_ + count);
+            try {
+                detail::UninitializedCopyN(GetAlloc(), data, count, Slot(size_));
+            }
+            catch (...) {
+                AnnotateSize(size_ + count, size_);
+                throw;
+            }
+            size_ += count;
+        });
+    }
+
+    void StealSegments(SegmentedVector& other) noexcept {
+        segments_ = std::exchange(other.segments_, {});
+        size_ = std::exchange(other.size_, 0);
+        num_segments_ = std::exchange(other.num_segments_, 0);
+    }
+
+    void SwapSegments(SegmentedVector& other) noexcept {
+        std::swap(segments_, other.segments_);
+        std::swap(size_, other.size_);
+        std::swap(num_segments_, other.num_segments_);
+    }
+
+    std::array<T*, Layout::kMaxSegments> segments_ = {};
+    size_t size_ = 0;
+    size_t num_segments_ = 0;
+};
@@ -0,0 +1,220 @@
+#pragma once
+#include "vector.h"
+
+// Хранилище для SmallVector: первые N элементов размещаются во встроенном буфере,
+// при переполнении элементы переезжают в динамическую память RawMemory
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+class SmallStorage {
+    static_assert(N > 0, "SmallStorage requires a non-empty inline buffer");
+
+public:
+    using allocator_type = Allocator;
+
+    static constexpr bool kCanReallocate = false;
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallStorage() = default;
+
+    explicit SmallStorage(const Allocator& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    SmallStorage(const SmallStorage&) = delete;
+    SmallStorage& operator=(const SmallStorage&) = delete;
+
+    // Переходит на динамический буфер memory. Элементы в текущем буфере должны быть уже разрушены
+    SmallStorage& operator=(RawMemory<T, Allocator>&& memory) noexcept {
+        heap_ = std::move(memory);
+        return *this;
+    }
+
+    T* operator+(size_t offset) noexcept {
+        assert(offset <= Capacity());
+        return GetAddress() + offset;
+    }
+
+    const T* operator+(size_t offset) const noexcept {
+        return const_cast<SmallStorage&>(*this) + offset;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallStorage&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Capacity());
+        return GetAddress()[index];
+    }
+
+    const T* GetAddress() const noexcept {
+        return const_cast<SmallStorage&>(*this).GetAddress();
+    }
+
+    T* GetAddress() noexcept {
+        return IsInline() ? GetInlineAddress() : heap_.GetAddress();
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    T* GetInlineAddress() noexcept {
+        return reinterpret_cast<T*>(inline_buffer_);
+    }
+
+    RawMemory<T, Allocator>& GetHeapMemory() noexcept {
+        return heap_;
+    }
+
+    Allocator& GetAllocator() noexcept {
+        return heap_.GetAllocator();
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+private:
+    RawMemory<T, Allocator> heap_;
+    alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+};
+
+// Вектор, хранящий до N элементов без обращения к аллокатору
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename StatsPolicy = NoVectorStats, typename CheckPolicy = DefaultVectorChecks>
+class SmallVector : public VectorBase<T, SmallStorage<T, N, Allocator>, GrowthPolicy, StatsPolicy, CheckPolicy> {
+    using Base = VectorBase<T, SmallStorage<T, N, Allocator>, GrowthPolicy, StatsPolicy, CheckPolicy>;
+    using typename Base::AllocTraits;
+    using Base::data_;
+    using Base::size_;
+    using Base::GetAlloc;
+
+public:
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& alloc) noexcept
+        : Base(std::in_place, alloc) {
+    }
+
+    explicit SmallVector(size_t size, const Allocator& alloc = Allocator())
+        : Base(std::in_place, alloc)
+    {
+        this->Resize(size);
+    }
+
+    SmallVector(size_t size, DefaultInitTag, const Allocator& alloc = Allocator())
+        : Base(std::in_place, alloc)
+    {
+        this->ResizeUninitialized(size);
+    }
+
+    SmallVector(size_t size, const T& value, const Allocator& alloc = Allocator())
+        : Base(std::in_place, alloc)
+    {
+        this->Assign(size, value);
+    }
+
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    SmallVector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : Base(std::in_place, alloc)
+    {
+        this->Assign(first, last);
+    }
+
+    SmallVector(std::initializer_list<T> values, const Allocator& alloc = Allocator())
+        : SmallVector(values.begin(), values.end(), alloc)
+    {
+    }
+
+    SmallVector(const SmallVector& other)
+        : Base(std::in_place, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+    {
+        typename Base::AnnotationScope annotations(*this);
+        this->Reserve(other.size_);
+        detail::UninitializedCopyN(GetAlloc(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : Base(std::in_place, std::move(other.data_.GetAllocator()))
+    {
+        MoveElementsFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            typename Base::AnnotationScope annotations(*this);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    this->DestroyAll();
+                    data_ = typename Base::Memory(data_.GetAllocator());
+                    this->InvalidateIterators();
+                }
+                data_.GetAllocator() = rhs.data_.GetAllocator();
+            }
+            this->AssignCopy(rhs);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+        && (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)) {
+        if (this != &rhs) {
+            typename Base::AnnotationScope annotations(*this);
+            this->DestroyAll();
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                data_ = typename Base::Memory(data_.GetAllocator());
+                data_.GetAllocator() = std::move(rhs.data_.GetAllocator());
+            }
+            MoveElementsFrom(rhs);
+        }
+        return *this;
+    }
+
+    // Если оба вектора в динамической памяти, меняются местами буферы. Иначе элементы
+    // перемещаются, как при трёх присваиваниях перемещением
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+        && (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)) {
+        if (!data_.IsInline() && !other.data_.IsInline()
+            && (AllocTraits::propagate_on_container_swap::value || data_.GetAllocator() == other.data_.GetAllocator())) {
+            data_.GetHeapMemory().Swap(other.data_.GetHeapMemory());
+            std::swap(size_, other.size_);
+            this->InvalidateIterators();
+            other.InvalidateIterators();
+            return;
+        }
+        SmallVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    bool IsInline() const noexcept {
+        return data_.IsInline();
+    }
+
+private:
+    // Забирает динамический буфер other, если это возможно, иначе перемещает его элементы.
+    // Текущий вектор должен быть пуст
+    void MoveElementsFrom(SmallVector& other) {
+        assert(size_ == 0);
+        typename Base::AnnotationScope annotations(*this);
+        typename Base::AnnotationScope other_annotations(other);
+        this->InvalidateIterators();
+        other.InvalidateIterators();
+        if (!other.data_.IsInline() && data_.GetAllocator() == other.data_.GetAllocator()) {
+            data_ = std::move(other.data_.GetHeapMemory());
+            size_ = std::exchange(other.size_, 0);
+            return;
+        }
+        this->Reserve(other.size_);
+        detail::UninitializedMoveN(GetAlloc(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+        other.DestroyAll();
+    }
+};
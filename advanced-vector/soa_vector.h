@@ -0,0 +1,328 @@
+#pragma once
+#include "vector.h"
+
+#include <tuple>
+
+// Вектор записей, хранящий каждое поле в отдельном буфере (structure of arrays). Проход по одному
+// полю читает только его столбец, а не записи целиком. Строка доступна как кортеж ссылок на поля,
+// столбец — как VectorView. Все столбцы имеют общую ёмкость и перевыделяются вместе: при нехватке
+// ёмкости новые буферы выделяются для всех столбцов сразу, новая строка создаётся в них до переноса
+// старых элементов, а при исключении в любом столбце уже созданные объекты разрушаются,
+// и вектор остаётся прежним. Под ASan ёмкость за последней строкой каждого столбца недоступна
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector requires at least one field");
+
+    static constexpr size_t kColumns = sizeof...(Fields);
+    using Indices = std::make_index_sequence<kColumns>;
+    using Columns = std::tuple<RawMemory<Fields>...>;
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    template <size_t I>
+    static constexpr bool kRelocateBitwise = detail::kRelocateBitwise<Field<I>, std::allocator<Field<I>>>;
+
+    // Перенос ни одного столбца не бросает исключений, поэтому элементы можно перемещать.
+    // Иначе все столбцы копируются, чтобы исключение в одном из них оставило старые элементы нетронутыми
+    static constexpr bool kNothrowRelocate =
+        ((detail::kRelocateBitwise<Fields, std::allocator<Fields>> || std::is_nothrow_move_constructible_v<Fields>)
+         && ...);
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+
+    SoAVector() = default;
+
+    explicit SoAVector(size_t size)
+        : columns_(AllocateColumns(size)) {
+        ConstructColumns(columns_, 0, size, [](auto, auto& memory, size_t first, size_t count) {
+            detail::UninitializedValueConstructN(memory.GetAllocator(), memory + first, count);
+        });
+        size_ = size;
+    }
+
+    SoAVector(const SoAVector& other)
+        : columns_(AllocateColumns(other.size_)) {
+        ConstructColumns(columns_, 0, other.size_, [&other](auto column, auto& memory, size_t first, size_t count) {
+            const auto& source = std::get<decltype(column)::value>(other.columns_);
+            detail::UninitializedCopyN(memory.GetAllocator(), source + first, count, memory + first);
+        });
+        size_ = other.size_;
+    }
+
+    SoAVector(SoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    ~SoAVector() {
+        DestroyRows(columns_, 0, size_);
+        AnnotateRows(columns_, size_, Capacity());
+    }
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SoAVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    void Swap(SoAVector& other) noexcept {
+        ForEachColumn([this, &other](auto column) {
+            std::get<decltype(column)::value>(columns_).Swap(std::get<decltype(column)::value>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            Columns new_columns = AllocateColumns(new_capacity);
+            RelocateTo(new_columns);
+            SwapColumns(new_columns, size_);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyRows(columns_, new_size, size_ - new_size);
+            AnnotateRows(columns_, size_, new_size);
+            size_ = new_size;
+        }
+        else if (new_size > size_) {
+            Reserve(new_size);
+            AnnotateRows(columns_, size_, new_size);
+            try {
+                ConstructColumns(columns_, size_, new_size - size_, [](auto, auto& memory, size_t first, size_t count) {
+                    detail::UninitializedValueConstructN(memory.GetAllocator(), memory + first, count);
+                });
+            }
+            catch (...) {
+                AnnotateRows(columns_, new_size, size_);
+                throw;
+            }
+            size_ = new_size;
+        }
+    }
+
+    void Clear() noexcept {
+        DestroyRows(columns_, 0, size_);
+        AnnotateRows(columns_, size_, 0);
+        size_ = 0;
+    }
+
+    // Принимает по одному аргументу для каждого поля. Аргументы могут ссылаться на элементы
+    // самого вектора: новая строка создаётся до переноса старых элементов в новые буферы
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == kColumns, "EmplaceBack takes one argument per field");
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        auto construct = [&values](auto column, auto& memory, size_t first, size_t) {
+            std::allocator_traits<std::decay_t<decltype(memory.GetAllocator())>>::construct(
+                memory.GetAllocator(), memory + first, std::get<decltype(column)::value>(std::move(values)));
+        };
+        if (size_ == Capacity()) {
+            Columns new_columns = AllocateColumns(DoublingGrowth::NextCapacity<value_type>(Capacity(), size_ + 1));
+            ConstructColumns(new_columns, size_, 1, construct);
+            try {
+                RelocateTo(new_columns);
+            }
+            catch (...) {
+                DestroyRows(new_columns, size_, 1);
+                throw;
+            }
+            SwapColumns(new_columns, size_ + 1);
+        }
+        else {
+            AnnotateRows(columns_, size_, size_ + 1);
+            try {
+                ConstructColumns(columns_, size_, 1, construct);
+            }
+            catch (...) {
+                AnnotateRows(columns_, size_ + 1, size_);
+                throw;
+            }
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    reference PushBack(const value_type& row) {
+        return std::apply([this](const Fields&... fields) -> reference {
+            return EmplaceBack(fields...);
+        }, row);
+    }
+
+    reference PushBack(value_type&& row) {
+        return std::apply([this](Fields&... fields) -> reference {
+            return EmplaceBack(std::move(fields)...);
+        }, row);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        DestroyRows(columns_, size_, 1);
+        AnnotateRows(columns_, size_ + 1, size_);
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Row(index, Indices{});
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return const_cast<SoAVector&>(*this).Row(index, Indices{});
+    }
+
+    template <size_t I>
+    VectorView<Field<I>> Column() noexcept {
+        return VectorView<Field<I>>(std::get<I>(columns_).GetAddress(), size_);
+    }
+
+    template <size_t I>
+    VectorView<const Field<I>> Column() const noexcept {
+        return VectorView<const Field<I>>(std::get<I>(columns_).GetAddress(), size_);
+    }
+
+private:
+    template <typename Action>
+    static void ForEachColumn(Action action) {
+        ForEachColumn(action, Indices{});
+    }
+
+    template <typename Action, size_t... Is>
+    static void ForEachColumn(Action& action, std::index_sequence<Is...>) {
+        (action(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    static Columns AllocateColumns(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    // Вызывает build(column, memory, first, count) для каждого столбца, который должен создать
+    // в memory объекты [first, first + count) и сам разрушить их при исключении. Если исключение
+    // выбросил очередной столбец, для предыдущих вызывается undo(column)
+    template <typename Build, typename Undo>
+    static void ConstructColumns(Columns& columns, size_t first, size_t count, Build build, Undo undo) {
+        size_t built = 0;
+        try {
+            ForEachColumn([&](auto column) {
+                build(column, std::get<decltype(column)::value>(columns), first, count);
+                ++built;
+            });
+        }
+        catch (...) {
+            ForEachColumn([&](auto column) {
+                if (decltype(column)::value < built) {
+                    undo(column);
+                }
+            });
+            throw;
+        }
+    }
+
+    template <typename Build>
+    static void ConstructColumns(Columns& columns, size_t first, size_t count, Build build) {
+        ConstructColumns(columns, first, count, build, [&columns, first, count](auto column) {
+            DestroyColumn<decltype(column)::value>(columns, first, count);
+        });
+    }
+
+    template <size_t I>
+    static void DestroyColumn(Columns& columns, size_t first, size_t count) noexcept {
+        auto& memory = std::get<I>(columns);
+        detail::DestroyN(memory.GetAllocator(), memory + first, count);
+    }
+
+    static void DestroyRows(Columns& columns, size_t first, size_t count) noexcept {
+        ForEachColumn([&](auto column) {
+            DestroyColumn<decltype(column)::value>(columns, first, count);
+        });
+    }
+
+    // Переносит все строки в new_columns. Побайтово перемещаемые столбцы копируются memcpy,
+    // остальные перемещаются или, если перенос какого-либо столбца может бросить, копируются.
+    // При исключении текущие элементы не изменяются
+    void RelocateTo(Columns& new_columns) {
+        ConstructColumns(new_columns, 0, size_, [this](auto column, auto& memory, size_t, size_t count) {
+            constexpr size_t kColumn = decltype(column)::value;
+            auto& source = std::get<kColumn>(columns_);
+            if constexpr (kRelocateBitwise<kColumn>) {
+                if (count != 0) {
+                    std::memcpy(static_cast<void*>(memory.GetAddress()), source.GetAddress(),
+                                count * sizeof(Field<kColumn>));
+                }
+            }
+            else if constexpr (kNothrowRelocate || !std::is_copy_constructible_v<Field<kColumn>>) {
+                detail::UninitializedMoveN(memory.GetAllocator(), source.GetAddress(), count, memory.GetAddress());
+            }
+            else {
+                detail::UninitializedCopyN(memory.GetAllocator(), static_cast<const Field<kColumn>*>(source.GetAddress()),
+                                           count, memory.GetAddress());
+            }
+        }, [&new_columns, this](auto column) {
+            // Побайтовые копии не владеют объектами: те по-прежнему принадлежат старым буферам
+            if constexpr (!kRelocateBitwise<decltype(column)::value>) {
+                DestroyColumn<decltype(column)::value>(new_columns, 0, size_);
+            }
+        });
+        ForEachColumn([this](auto column) {
+            if constexpr (!kRelocateBitwise<decltype(column)::value>) {
+                DestroyColumn<decltype(column)::value>(columns_, 0, size_);
+            }
+        });
+    }
+
+    // Под ASan в каждом столбце живы первые new_size строк вместо old_size
+    static void AnnotateRows(Columns& columns, size_t old_size, size_t new_size) noexcept {
+        ForEachColumn([&columns, old_size, new_size](auto column) {
+            auto& memory = std::get<decltype(column)::value>(columns);
+            detail::AnnotateContainer(memory.GetAddress(), memory.Capacity(), old_size, new_size);
+        });
+    }
+
+    // Делает new_columns текущими столбцами с new_size строками. Старые буферы, которые освободит
+    // new_columns, открываются целиком, а в новых помечаются ячейки за new_size
+    void SwapColumns(Columns& new_columns, size_t new_size) noexcept {
+        ForEachColumn([this, &new_columns, new_size](auto column) {
+            auto& current = std::get<decltype(column)::value>(columns_);
+            auto& fresh = std::get<decltype(column)::value>(new_columns);
+            detail::AnnotateContainer(current.GetAddress(), current.Capacity(), size_, current.Capacity());
+            detail::AnnotateContainer(fresh.GetAddress(), fresh.Capacity(), fresh.Capacity(), new_size);
+            current.Swap(fresh);
+        });
+    }
+
+    template <size_t... Is>
+    reference Row(size_t index, std::index_sequence<Is...>) noexcept {
+        return reference(std::get<Is>(columns_)[index]...);
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
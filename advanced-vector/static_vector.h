@@ -0,0 +1,198 @@
+#pragma once
+#include "vector.h"
+
+namespace detail {
+
+// Аллокатор хранилища StaticStorage. Вектор обращается к нему, только когда элементам
+// не хватает встроенного буфера, поэтому любая попытка выделить память означает
+// превышение ёмкости и завершается исключением до изменения вектора
+template <typename T>
+struct NoHeapAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    NoHeapAllocator() noexcept = default;
+    template <typename U>
+    NoHeapAllocator(const NoHeapAllocator<U>&) noexcept {
+    }
+
+    [[noreturn]] T* allocate(size_t) {
+        throw std::length_error("StaticVector capacity exceeded");
+    }
+
+    void deallocate(T*, size_t) noexcept {
+    }
+
+    template <typename U>
+    bool operator==(const NoHeapAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const NoHeapAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Политика роста StaticVector: ёмкость не может превысить N
+template <size_t N>
+struct FixedCapacityGrowth {
+    template <typename T>
+    static size_t NextCapacity(size_t /*capacity*/, size_t min_capacity) {
+        if (min_capacity > N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+        return N;
+    }
+};
+
+}  // namespace detail
+
+// Хранилище StaticVector: только встроенный буфер на N элементов
+template <typename T, size_t N>
+class StaticStorage : private detail::NoHeapAllocator<T> {
+    static_assert(N > 0, "StaticStorage requires a non-empty buffer");
+
+public:
+    using allocator_type = detail::NoHeapAllocator<T>;
+
+    static constexpr bool kCanReallocate = false;
+    static constexpr bool kFixedCapacity = true;
+    static constexpr size_t kInlineCapacity = N;
+
+    StaticStorage() = default;
+
+    StaticStorage(const StaticStorage&) = delete;
+    StaticStorage& operator=(const StaticStorage&) = delete;
+
+    // Динамический буфер выделить невозможно, поэтому сюда попадает только пустая память
+    StaticStorage& operator=(RawMemory<T, allocator_type>&& memory) noexcept {
+        assert(memory.GetAddress() == nullptr);
+        static_cast<void>(memory);
+        return *this;
+    }
+
+    T* operator+(size_t offset) noexcept {
+        assert(offset <= N);
+        return GetAddress() + offset;
+    }
+
+    const T* operator+(size_t offset) const noexcept {
+        return const_cast<StaticStorage&>(*this) + offset;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StaticStorage&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < N);
+        return GetAddress()[index];
+    }
+
+    const T* GetAddress() const noexcept {
+        return const_cast<StaticStorage&>(*this).GetAddress();
+    }
+
+    T* GetAddress() noexcept {
+        return reinterpret_cast<T*>(buffer_);
+    }
+
+    T* GetInlineAddress() noexcept {
+        return GetAddress();
+    }
+
+    size_t Capacity() const noexcept {
+        return N;
+    }
+
+    bool IsInline() const noexcept {
+        return true;
+    }
+
+    allocator_type& GetAllocator() noexcept {
+        return *this;
+    }
+
+    const allocator_type& GetAllocator() const noexcept {
+        return *this;
+    }
+
+private:
+    alignas(T) unsigned char buffer_[N * sizeof(T)];
+};
+
+// Вектор фиксированной ёмкости N, никогда не выделяющий память. Элементами управляет тот же
+// VectorBase, что и у Vector; операция, которой не хватает ёмкости (вставка в полный вектор,
+// Reserve или Resize больше N), выбрасывает std::length_error, не изменяя вектор
+template <typename T, size_t N, typename StatsPolicy = NoVectorStats, typename CheckPolicy = DefaultVectorChecks>
+class StaticVector
+    : public VectorBase<T, StaticStorage<T, N>, detail::FixedCapacityGrowth<N>, StatsPolicy, CheckPolicy> {
+    using Base = VectorBase<T, StaticStorage<T, N>, detail::FixedCapacityGrowth<N>, StatsPolicy, CheckPolicy>;
+    using Base::data_;
+    using Base::size_;
+    using Base::GetAlloc;
+
+public:
+    static constexpr size_t kCapacity = N;
+
+    StaticVector() = default;
+
+    explicit StaticVector(size_t size) {
+        this->Resize(size);
+    }
+
+    StaticVector(size_t size, DefaultInitTag) {
+        this->ResizeUninitialized(size);
+    }
+
+    StaticVector(size_t size, const T& value) {
+        this->Assign(size, value);
+    }
+
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    StaticVector(InputIt first, InputIt last) {
+        this->Assign(first, last);
+    }
+
+    StaticVector(std::initializer_list<T> values)
+        : StaticVector(values.begin(), values.end()) {
+    }
+
+    StaticVector(const StaticVector& other)
+        : Base() {
+        detail::UninitializedCopyN(GetAlloc(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+    }
+
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : Base() {
+        detail::UninitializedMoveN(GetAlloc(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+    }
+
+    StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            this->AssignCopy(rhs);
+        }
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                         && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            this->Assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+        }
+        return *this;
+    }
+
+    void Swap(StaticVector& other) noexcept(std::is_nothrow_move_assignable_v<T>
+                                            && std::is_nothrow_move_constructible_v<T>) {
+        StaticVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    bool Full() const noexcept {
+        return size_ == N;
+    }
+};
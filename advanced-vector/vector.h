@@ -1,35 +1,573 @@
 #pragma once
 #include <cassert>
+#include <cstddef>
 #include <cstdlib>
 #include <new>
 #include <utility>
 #include <memory>
 #include <stdexcept>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <thread>
+#include <type_traits>
 
+#if defined(__SANITIZE_ADDRESS__)
+#define VECTOR_HAS_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define VECTOR_HAS_ASAN 1
+#endif
+#endif
+
+// Под AddressSanitizer ёмкость за концом вектора помечается недоступной;
+// -DVECTOR_NO_ASAN_ANNOTATIONS отключает разметку
+#if defined(VECTOR_HAS_ASAN) && !defined(VECTOR_NO_ASAN_ANNOTATIONS)
+#define VECTOR_ASAN_ANNOTATIONS 1
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+// Признак того, что объект можно переместить в другую область памяти побайтовым копированием,
+// не вызывая конструктор перемещения и деструктор исходного объекта.
+// Пользователь может специализировать шаблон для своих типов
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {
+};
+
+template <typename T, typename U>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<U>>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Аллокатор на основе malloc/realloc/free. Метод reallocate позволяет вектору
+// расширять буфер тривиально перемещаемых элементов без копирования, если это возможно
+template <typename T>
+struct MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "MallocAllocator does not support over-aligned types");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MallocAllocator() noexcept = default;
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    // Как и у std::allocator, запрос больше max_size() не должен превращаться в короткий буфер
+    static constexpr size_t max_size() noexcept {
+        return std::numeric_limits<size_t>::max() / sizeof(T);
+    }
+
+    T* allocate(size_t n) {
+        if (n > max_size()) {
+            throw std::bad_alloc();
+        }
+        if (void* p = std::malloc(n * sizeof(T))) {
+            return static_cast<T*>(p);
+        }
+        throw std::bad_alloc();
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        std::free(p);
+    }
+
+    // Содержимое буфера переносится побайтово, поэтому вызывать можно только для тривиально перемещаемых T
+    T* reallocate(T* p, size_t /*old_n*/, size_t new_n) {
+        if (new_n > max_size()) {
+            throw std::bad_alloc();
+        }
+        if (void* new_p = std::realloc(p, new_n * sizeof(T))) {
+            return static_cast<T*>(new_p);
+        }
+        throw std::bad_alloc();
+    }
+
+    bool operator==(const MallocAllocator&) const noexcept {
+        return true;
+    }
+    bool operator!=(const MallocAllocator&) const noexcept {
+        return false;
+    }
+};
+
+// Можно ли помечать для ASan неиспользуемую ёмкость блоков аллокатора. Разметка меняет
+// теневую память до конца последней 8-байтной гранулы блока, поэтому она допустима,
+// только если блоки не делят гранулы с чужими данными, как у malloc и operator new.
+// Пользователь может специализировать шаблон для своих аллокаторов
+template <typename Allocator>
+struct is_asan_annotatable : std::false_type {
+};
+
+template <typename T>
+struct is_asan_annotatable<std::allocator<T>> : std::true_type {
+};
+
+template <typename T>
+struct is_asan_annotatable<MallocAllocator<T>> : std::true_type {
+};
+
+// Аллокатор, выравнивающий буфер по Alignment байт (линия кеша, ширина регистров AVX2/AVX-512).
+// Размер блока округляется вверх до кратного PadTo байт, а байты после последнего элемента
+// блока обнуляются, поэтому векторные алгоритмы могут читать [begin(), begin() + PaddedBytes(Capacity()))
+// целыми регистрами без скалярного хвоста. При Alignment = PadTo = 64 блок занимает целые
+// линии кеша и не делит их с чужими данными (нет ложного разделения между потоками)
+template <typename T, size_t Alignment = 64, size_t PadTo = Alignment>
+struct AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+    static_assert(PadTo != 0, "PadTo must be positive");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_t kAlignment = Alignment;
+    static constexpr size_t kPadTo = PadTo;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, PadTo>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, PadTo>&) noexcept {
+    }
+
+    // Число байт, выделяемых под n элементов
+    static constexpr size_t PaddedBytes(size_t n) noexcept {
+        return (n * sizeof(T) + PadTo - 1) / PadTo * PadTo;
+    }
+
+    T* allocate(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - PadTo) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        const size_t bytes = PaddedBytes(n);
+        auto* p = static_cast<unsigned char*>(::operator new(bytes, std::align_val_t{ Alignment }));
+        std::memset(p + n * sizeof(T), 0, bytes - n * sizeof(T));
+        return reinterpret_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ::operator delete(static_cast<void*>(p), PaddedBytes(n), std::align_val_t{ Alignment });
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment, PadTo>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment, PadTo>&) const noexcept {
+        return false;
+    }
+};
+
+// Тег для конструкторов, оставляющих элементы тривиальных типов неинициализированными
+struct DefaultInitTag {
+};
+inline constexpr DefaultInitTag default_init{};
+
+// Тег для операций, создающих элементы в нескольких потоках. Диапазон делится на части
+// не меньше min_chunk_bytes байт, каждую из которых создаёт свой поток; threads = 0 означает
+// std::thread::hardware_concurrency(). Метод construct аллокатора вызывается из нескольких потоков
+struct ParallelTag {
+    unsigned threads = 0;
+    size_t min_chunk_bytes = size_t{1} << 20;
+};
+inline constexpr ParallelTag parallel{};
+
+namespace detail {
+
+template <typename Allocator, typename T, typename = void>
+struct HasDefaultConstruct : std::false_type {
+};
+template <typename Allocator, typename T>
+struct HasDefaultConstruct<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().construct(std::declval<T*>()))>>
+    : std::true_type {
+};
+
+template <typename Allocator, typename T, typename = void>
+struct HasConstruct : std::false_type {
+};
+template <typename Allocator, typename T>
+struct HasConstruct<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().construct(std::declval<T*>(), std::declval<T&&>()))>>
+    : std::true_type {
+};
+
+template <typename Allocator, typename T, typename = void>
+struct HasDestroy : std::false_type {
+};
+template <typename Allocator, typename T>
+struct HasDestroy<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().destroy(std::declval<T*>()))>>
+    : std::true_type {
+};
+
+template <typename Allocator, typename T, typename = void>
+struct HasReallocate : std::false_type {
+};
+template <typename Allocator, typename T>
+struct HasReallocate<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+    std::declval<T*>(), std::declval<size_t>(), std::declval<size_t>()))>>
+    : std::true_type {
+};
+
+// construct/destroy у polymorphic_allocator лишь передают объекту тот же ресурс памяти
+// (uses-allocator construction), который объект сохраняет и при побайтовом переносе.
+// Наличие его устаревшего в C++20 destroy поэтому не проверяется
+template <typename Allocator>
+struct IsPolymorphicAllocator : std::false_type {
+};
+template <typename U>
+struct IsPolymorphicAllocator<std::pmr::polymorphic_allocator<U>> : std::true_type {
+};
+
+// construct аллокатора сводится к placement new: у std::allocator всегда, у polymorphic_allocator —
+// для типов, которые не принимают аллокатор
+template <typename Allocator, typename T>
+inline constexpr bool kPlainConstruct = std::is_same_v<Allocator, std::allocator<T>>
+    || (IsPolymorphicAllocator<Allocator>::value && !std::uses_allocator_v<T, Allocator>);
+
+// Побайтовое перемещение допустимо, только если аллокатор не переопределяет construct/destroy.
+// disjunction не инстанцирует проверки членов аллокатора, если ответ уже известен
+template <typename T, typename Allocator>
+inline constexpr bool kRelocateBitwise = is_trivially_relocatable_v<T>
+    && std::disjunction_v<std::is_same<Allocator, std::allocator<T>>, IsPolymorphicAllocator<Allocator>,
+                          std::conjunction<std::negation<HasConstruct<Allocator, T>>,
+                                           std::negation<HasDestroy<Allocator, T>>>>;
+
+// Разрушает n объектов, начиная с first, через allocator_traits
+template <typename Allocator, typename T>
+void DestroyN(Allocator& alloc, T* first, size_t n) noexcept {
+    for (; n > 0; ++first, --n) {
+        std::allocator_traits<Allocator>::destroy(alloc, first);
+    }
+}
+
+// Конструирует n объектов в dest при помощи init(T* place, size_t index).
+// Если очередное конструирование выбросило исключение, уже созданные объекты разрушаются
+template <typename Allocator, typename T, typename Init>
+T* UninitializedInitN(Allocator& alloc, T* dest, size_t n, Init init) {
+    size_t i = 0;
+    try {
+        for (; i < n; ++i) {
+            init(dest + i, i);
+        }
+    }
+    catch (...) {
+        DestroyN(alloc, dest, i);
+        throw;
+    }
+    return dest + n;
+}
+
+template <typename Allocator, typename T>
+T* UninitializedValueConstructN(Allocator& alloc, T* dest, size_t n) {
+    return UninitializedInitN(alloc, dest, n, [&alloc](T* place, size_t) {
+        std::allocator_traits<Allocator>::construct(alloc, place);
+    });
+}
+
+// Инициализация по умолчанию: для тривиальных T память остаётся нетронутой.
+// Если аллокатор переопределяет construct, используется он, и объекты инициализируются значением
+template <typename Allocator, typename T>
+T* UninitializedDefaultConstructN(Allocator& alloc, T* dest, size_t n) {
+    if constexpr (HasDefaultConstruct<Allocator, T>::value && !kPlainConstruct<Allocator, T>) {
+        return UninitializedValueConstructN(alloc, dest, n);
+    }
+    else if constexpr (std::is_trivially_default_constructible_v<T>) {
+        return dest + n;
+    }
+    else {
+        return UninitializedInitN(alloc, dest, n, [](T* place, size_t) {
+            ::new (static_cast<void*>(place)) T;
+        });
+    }
+}
+
+// Тривиально копируемые объекты копируются одним memcpy, если аллокатор не переопределяет construct
+template <typename Allocator, typename T>
+T* UninitializedCopyN(Allocator& alloc, const T* src, size_t n, T* dest) {
+    if constexpr (std::is_trivially_copyable_v<T>
+                  && (kPlainConstruct<Allocator, T> || !HasConstruct<Allocator, T>::value)) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dest), src, n * sizeof(T));
+        }
+        return dest + n;
+    }
+    else {
+        return UninitializedInitN(alloc, dest, n, [&alloc, src](T* place, size_t i) {
+            std::allocator_traits<Allocator>::construct(alloc, place, src[i]);
+        });
+    }
+}
+
+template <typename Allocator, typename T>
+T* UninitializedMoveN(Allocator& alloc, T* src, size_t n, T* dest) {
+    return UninitializedInitN(alloc, dest, n, [&alloc, src](T* place, size_t i) {
+        std::allocator_traits<Allocator>::construct(alloc, place, std::move(src[i]));
+    });
+}
+
+// Перемещает элементы, если перемещение не бросает исключений (или копирование невозможно),
+// иначе копирует их, сохраняя исходные объекты нетронутыми
+template <typename Allocator, typename T>
+T* UninitializedMoveIfNoexceptN(Allocator& alloc, T* src, size_t n, T* dest) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        return UninitializedMoveN(alloc, src, n, dest);
+    }
+    else {
+        return UninitializedCopyN(alloc, static_cast<const T*>(src), n, dest);
+    }
+}
+
+// Конструирует в dest n объектов, копируя их из последовательности, начинающейся с first
+template <typename Allocator, typename T, typename InputIt>
+T* UninitializedCopyFromN(Allocator& alloc, InputIt first, size_t n, T* dest) {
+    return UninitializedInitN(alloc, dest, n, [&alloc, &first](T* place, size_t) {
+        std::allocator_traits<Allocator>::construct(alloc, place, *first);
+        ++first;
+    });
+}
+
+// Лежит ли объект arg (или его подобъект) внутри n элементов, начиная с first. Аргументы,
+// ссылающиеся на элементы вектора, нельзя использовать после сдвига или переноса элементов
+template <typename T, typename Arg>
+bool PointsInto(const Arg& arg, const T* first, size_t n) noexcept {
+    if constexpr (std::is_function_v<Arg>) {
+        return false;
+    }
+    else {
+        const auto* address = reinterpret_cast<const unsigned char*>(std::addressof(arg));
+        const auto* begin = reinterpret_cast<const unsigned char*>(first);
+        const std::less<const unsigned char*> less;
+        return !less(address, begin) && less(address, begin + n * sizeof(T));
+    }
+}
+
+// Число частей, на которые делится создание n объектов T
+template <typename T>
+size_t ParallelChunkCount(size_t n, ParallelTag tag) noexcept {
+    const size_t threads = tag.threads != 0 ? tag.threads : std::max(1u, std::thread::hardware_concurrency());
+    const size_t min_chunk = std::max<size_t>(1, tag.min_chunk_bytes / sizeof(T));
+    return std::max<size_t>(1, std::min(threads, n / min_chunk));
+}
+
+// Конструирует n объектов в dest, разделив их на части, каждую из которых создаёт отдельный поток
+// вызовом init_chunk(T* chunk, size_t offset, size_t count). init_chunk сам разрушает объекты
+// своей части при исключении. Если хотя бы одна часть не создана, объекты остальных частей
+// разрушаются, и выбрасывается исключение первой из неудавшихся частей
+template <typename Allocator, typename T, typename InitChunk>
+T* ParallelInitN(Allocator& alloc, T* dest, size_t n, ParallelTag tag, InitChunk init_chunk) {
+    const size_t chunks = ParallelChunkCount<T>(n, tag);
+    if (chunks == 1) {
+        init_chunk(dest, size_t{0}, n);
+        return dest + n;
+    }
+    auto chunk_begin = [n, chunks](size_t chunk) {
+        return n / chunks * chunk + std::min(chunk, n % chunks);
+    };
+    std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[chunks]);
+    auto run = [&](size_t chunk) noexcept {
+        const size_t offset = chunk_begin(chunk);
+        try {
+            init_chunk(dest + offset, offset, chunk_begin(chunk + 1) - offset);
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    std::unique_ptr<std::thread[]> threads(new std::thread[chunks - 1]);
+    size_t started = 0;
+    try {
+        for (; started + 1 < chunks; ++started) {
+            threads[started] = std::thread(run, started + 1);
+        }
+    }
+    catch (...) {
+        // Не удалось создать поток: оставшиеся части создаются в текущем потоке
+    }
+    for (size_t chunk = started + 1; chunk < chunks; ++chunk) {
+        run(chunk);
+    }
+    run(0);
+    for (size_t i = 0; i < started; ++i) {
+        threads[i].join();
+    }
+    std::exception_ptr error;
+    for (size_t chunk = 0; chunk < chunks && !error; ++chunk) {
+        error = errors[chunk];
+    }
+    if (error) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (!errors[chunk]) {
+                DestroyN(alloc, dest + chunk_begin(chunk), chunk_begin(chunk + 1) - chunk_begin(chunk));
+            }
+        }
+        std::rethrow_exception(error);
+    }
+    return dest + n;
+}
+
+// Ёмкость встроенного буфера хранилища (0, если его нет)
+template <typename Storage, typename = void>
+struct InlineCapacity : std::integral_constant<size_t, 0> {
+};
+template <typename Storage>
+struct InlineCapacity<Storage, std::void_t<decltype(Storage::kInlineCapacity)>>
+    : std::integral_constant<size_t, Storage::kInlineCapacity> {
+};
+
+// Хранилище, ёмкость которого не может вырасти (Storage::kFixedCapacity)
+template <typename Storage, typename = void>
+struct IsFixedCapacity : std::false_type {
+};
+template <typename Storage>
+struct IsFixedCapacity<Storage, std::void_t<decltype(Storage::kFixedCapacity)>>
+    : std::bool_constant<Storage::kFixedCapacity> {
+};
+
+template <typename Policy, typename T, typename = void>
+struct HasShrinkCapacity : std::false_type {
+};
+template <typename Policy, typename T>
+struct HasShrinkCapacity<Policy, T, std::void_t<decltype(Policy::template ShrinkCapacity<T>(size_t{}, size_t{}))>>
+    : std::true_type {
+};
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+template <typename It, typename = void>
+struct IsInputIterator : std::false_type {
+};
+template <typename It>
+struct IsInputIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::input_iterator_tag> {
+};
+
+template <typename It>
+using EnableIfInputIterator = std::enable_if_t<IsInputIterator<It>::value, int>;
+
+template <typename It>
+inline constexpr bool kIsForwardIterator = std::is_convertible_v<IteratorCategory<It>, std::forward_iterator_tag>;
+
+// Последовательность из одного и того же значения, позволяющая вставлять n копий
+// тем же кодом, что и диапазоны
 template <typename T>
-class RawMemory {
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    RepeatIterator(const T& value, size_t index) noexcept
+        : value_(&value)
+        , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return *value_;
+    }
+    pointer operator->() const noexcept {
+        return value_;
+    }
+    RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    RepeatIterator operator++(int) noexcept {
+        RepeatIterator old = *this;
+        ++index_;
+        return old;
+    }
+    bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+private:
+    const T* value_;
+    size_t index_;
+};
+
+}  // namespace detail
+
+// Аллокатор хранится как приватная база, чтобы пустые аллокаторы (std::allocator)
+// не увеличивали размер RawMemory и Vector
+template <typename T, typename Allocator = std::allocator<T>>
+class RawMemory : private Allocator {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Allocator::value_type must be the same as T");
+
 public:
+    using allocator_type = Allocator;
+
+    // Аллокатор умеет расширять блок на месте или переносить его содержимое побайтово
+    static constexpr bool kCanReallocate = detail::HasReallocate<Allocator, T>::value;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    explicit RawMemory(const Allocator& alloc) noexcept
+        : Allocator(alloc) {
+    }
+
+    explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : Allocator(alloc)
+        , buffer_(Allocate(capacity))
+        , capacity_(capacity) {
+    }
+
+    // Принимает владение буфером на capacity элементов, выделенным через AllocTraits::allocate(alloc, capacity)
+    RawMemory(T* buffer, size_t capacity, const Allocator& alloc) noexcept
+        : Allocator(alloc)
+        , buffer_(buffer)
         , capacity_(capacity) {
     }
 
     ~RawMemory() {
-        Deallocate(buffer_);
+        Deallocate(buffer_, capacity_);
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
-    RawMemory(RawMemory&& other) noexcept 
-        : buffer_(std::move(other.GetAddress()))
-        , capacity_(std::move(other.Capacity())) {
+    RawMemory(RawMemory&& other) noexcept
+        : Allocator(std::move(other.GetAllocator()))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
     }
+    // Аллокатор переносится только при propagate_on_container_move_assignment,
+    // поэтому вызывающий обязан гарантировать равенство аллокаторов в остальных случаях
     RawMemory& operator=(RawMemory&& rhs) noexcept {
-        buffer_ = std::move(rhs.GetAddress());
-        capacity_ = std::move(rhs.Capacity());
+        if (this != &rhs) {
+            Deallocate(buffer_, capacity_);
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+            capacity_ = std::exchange(rhs.capacity_, 0);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                GetAllocator() = std::move(rhs.GetAllocator());
+            }
+        }
+        return *this;
+    }
+
+    // Отказывается от владения буфером, не освобождая его
+    T* Release() noexcept {
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
     }
 
     T* operator+(size_t offset) noexcept {
@@ -51,9 +589,26 @@ public:
         return buffer_[index];
     }
 
+    // Аллокаторы обмениваются только при propagate_on_container_swap
     void Swap(RawMemory& other) noexcept {
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(GetAllocator(), other.GetAllocator());
+        }
+    }
+
+    // Изменяет ёмкость буфера, сохраняя его содержимое побайтово. Доступно при kCanReallocate
+    void Reallocate(size_t new_capacity) {
+        static_assert(kCanReallocate, "Allocator does not provide reallocate()");
+        if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+        }
+        else {
+            buffer_ = GetAllocator().reallocate(buffer_, capacity_, new_capacity);
+        }
+        capacity_ = new_capacity;
     }
 
     const T* GetAddress() const noexcept {
@@ -68,15 +623,25 @@ public:
         return capacity_;
     }
 
+    Allocator& GetAllocator() noexcept {
+        return *this;
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return *this;
+    }
+
 private:
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    T* Allocate(size_t n) {
+        return n != 0 ? AllocTraits::allocate(GetAllocator(), n) : nullptr;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(GetAllocator(), buf, n);
+        }
     }
 
     T* buffer_ = nullptr;
@@ -84,126 +649,636 @@ private:
 };
 
 
+// Невладеющее представление непрерывного диапазона элементов, аналог std::span из C++20.
+// Остаётся действительным, пока вектор не перевыделил память и не был разрушен
 template <typename T>
-class Vector {
+class VectorView {
 public:
+    using value_type = std::remove_cv_t<T>;
     using iterator = T*;
-    using const_iterator = const T*;
 
-    iterator begin() noexcept {
-        return data_.GetAddress();
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    VectorView() noexcept = default;
+
+    VectorView(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
     }
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+
+    template <typename U, std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>, int> = 0>
+    VectorView(const VectorView<U>& other) noexcept
+        : data_(other.Data())
+        , size_(other.Size()) {
     }
-    const_iterator begin() const noexcept {
-        return data_.GetAddress();
+
+    T* Data() const noexcept {
+        return data_;
     }
-    const_iterator end() const noexcept {
-        return data_.GetAddress() + size_;
+    size_t Size() const noexcept {
+        return size_;
     }
-    const_iterator cbegin() const noexcept {
-        return data_.GetAddress();
+    bool Empty() const noexcept {
+        return size_ == 0;
     }
-    const_iterator cend() const noexcept {
-        return data_.GetAddress() + size_;
+    size_t SizeBytes() const noexcept {
+        return size_ * sizeof(T);
     }
 
-    Vector() = default;
+    iterator begin() const noexcept {
+        return data_;
+    }
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
 
-    explicit Vector(size_t size)
-        : data_(size)
-        , size_(size)  //
-    {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+    T& Front() const noexcept {
+        assert(size_ > 0);
+        return data_[0];
+    }
+    T& Back() const noexcept {
+        assert(size_ > 0);
+        return data_[size_ - 1];
     }
 
-    Vector(const Vector & other)
-        : data_(other.size_)
-        , size_(other.size_)
-    {
-        std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+    // Элементы [offset, offset + count); count усекается до конца диапазона
+    VectorView Subview(size_t offset, size_t count = npos) const noexcept {
+        assert(offset <= size_);
+        return VectorView(data_ + offset, std::min(count, size_ - offset));
     }
 
-    Vector(Vector&& other) noexcept {
-        Swap(other);
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+class Vector;
+
+// Буфер с элементами, забранный у Vector через Release(). Владеет элементами и памятью:
+// деструктор разрушает элементы и освобождает память аллокатором, которым она выделена.
+// Буфер можно снова передать вектору через Vector::Adopt без копирования
+template <typename T, typename Allocator = std::allocator<T>>
+class VectorBuffer {
+    template <typename, typename, typename, typename, typename>
+    friend class Vector;
+
+public:
+    VectorBuffer() = default;
+
+    VectorBuffer(VectorBuffer&& other) noexcept
+        : memory_(std::move(other.memory_))
+        , size_(std::exchange(other.size_, 0)) {
     }
 
-    void Reserve(size_t new_capacity) {
-        if (new_capacity <= Capacity()) {
-            return;
+    VectorBuffer& operator=(VectorBuffer&& rhs) noexcept {
+        if (this != &rhs) {
+            detail::DestroyN(memory_.GetAllocator(), memory_.GetAddress(), size_);
+            memory_ = std::move(rhs.memory_);
+            size_ = std::exchange(rhs.size_, 0);
         }
-        RawMemory<T> new_data(new_capacity);
-        MoveOrCopyRawMemory(new_data);
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+        return *this;
+    }
+
+    ~VectorBuffer() {
+        detail::DestroyN(memory_.GetAllocator(), memory_.GetAddress(), size_);
     }
 
+    T* Data() noexcept {
+        return memory_.GetAddress();
+    }
+    const T* Data() const noexcept {
+        return memory_.GetAddress();
+    }
     size_t Size() const noexcept {
         return size_;
     }
-
     size_t Capacity() const noexcept {
-        return data_.Capacity();
+        return memory_.Capacity();
     }
-
-    void Resize(size_t new_size) {
-        if (new_size < size_) {
-            std::destroy_n(data_.GetAddress()+ new_size, size_ - new_size);
-            size_ = new_size;
-        }
-        else if (new_size > size_) {
-            Reserve(new_size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
-            size_ = new_size;
-        }
+    const Allocator& GetAllocator() const noexcept {
+        return memory_.GetAllocator();
     }
 
-    void PushBack(const T& value) {
-        EmplaceBack(value);
+    VectorView<T> View() noexcept {
+        return VectorView<T>(Data(), size_);
     }
-    void PushBack(T&& value) {
-        EmplaceBack(std::move(value));
+    VectorView<const T> View() const noexcept {
+        return VectorView<const T>(Data(), size_);
     }
 
-    template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
-        return *(Emplace(cend(), std::forward<Args>(args)...));
+    // Отказывается от владения, как unique_ptr::release: вызывающий обязан разрушить Size() элементов
+    // и освободить память на Capacity() элементов аллокатором GetAllocator()
+    T* Leak() noexcept {
+        size_ = 0;
+        return memory_.Release();
     }
 
-    void PopBack() noexcept {
-        assert(size_ > 0);
-        std::destroy_n(data_ + size_ - 1, 1);
-        --size_;
+private:
+    VectorBuffer(RawMemory<T, Allocator>&& memory, size_t size) noexcept
+        : memory_(std::move(memory))
+        , size_(size) {
     }
 
-    template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args)
-    {
-        assert(pos >= cbegin() && pos <= cend());
-        size_t dist = std::distance(cbegin(), pos);
-        if (size_ == Capacity()) {
-            EmplaceWhithFullCapacity(dist, std::forward<Args>(args)...);
+    RawMemory<T, Allocator> memory_;
+    size_t size_ = 0;
+};
+
+
+// Политики роста ёмкости. NextCapacity<T>(capacity, min_capacity) возвращает новую ёмкость
+// не меньше min_capacity, когда вектору не хватает текущей ёмкости capacity
+
+// Удвоение ёмкости, начиная с одного элемента
+struct DoublingGrowth {
+    template <typename T>
+    static size_t NextCapacity(size_t capacity, size_t min_capacity) noexcept {
+        const size_t max_capacity = std::numeric_limits<size_t>::max() / sizeof(T);
+        size_t new_capacity = capacity == 0 ? 1 : (capacity > max_capacity / 2 ? max_capacity : capacity * 2);
+        return std::max(new_capacity, min_capacity);
+    }
+};
+
+// Рост в Numerator/Denominator раз. Первое выделение занимает не меньше MinInitialBytes байт,
+// чтобы маленькие элементы не проходили через ёмкости 1, 2, 3, ...
+template <size_t Numerator, size_t Denominator, size_t MinInitialBytes = 64>
+struct FactorGrowth {
+    static_assert(Numerator > Denominator && Denominator > 0, "Growth factor must be greater than 1");
+
+    template <typename T>
+    static size_t NextCapacity(size_t capacity, size_t min_capacity) noexcept {
+        const size_t max_capacity = std::numeric_limits<size_t>::max() / sizeof(T);
+        size_t new_capacity = 0;
+        if (capacity == 0) {
+            new_capacity = std::max<size_t>(1, MinInitialBytes / sizeof(T));
         }
-        else if (pos == cend())
-        {
-            new(data_ + size_) T(std::forward<Args>(args)...);
+        else if (capacity > max_capacity / Numerator) {
+            new_capacity = max_capacity;
         }
         else {
-            EmplaceWithEmptyCapacity(dist, std::forward<Args>(args)...);
+            new_capacity = std::max(capacity + 1, capacity * Numerator / Denominator);
         }
-        ++size_;
-        return data_ + dist;
+        return std::max(new_capacity, min_capacity);
     }
+};
 
-    iterator Erase(const_iterator pos) {
-        assert(size_ > 0);
-        assert(pos >= cbegin() && pos <= cend());
-        size_t dist = std::distance(cbegin(), pos);
-        std::move(begin() + dist + 1, end(), begin() + dist);
-        std::destroy_n(data_ + size_ - 1, 1);
-        --size_;
-        return begin() + dist;
+using OneAndHalfGrowth = FactorGrowth<3, 2>;
+using GoldenRatioGrowth = FactorGrowth<1618, 1000>;
+
+// Добавляет к BasePolicy автоматическое уменьшение ёмкости: когда после удаления элементов
+// занято не больше 1/ShrinkDivisor ёмкости, она уменьшается вдвое. Запас между порогами
+// роста и уменьшения не даёт вектору перевыделять память при колебаниях размера
+template <typename BasePolicy = DoublingGrowth, size_t ShrinkDivisor = 4>
+struct AutoShrinkGrowth : BasePolicy {
+    static_assert(ShrinkDivisor > 2, "Shrink threshold must leave room for hysteresis");
+
+    template <typename T>
+    static size_t ShrinkCapacity(size_t capacity, size_t size) noexcept {
+        return size <= capacity / ShrinkDivisor ? capacity / 2 : capacity;
+    }
+};
+
+// Округляет ёмкость, выбранную политикой BasePolicy, вверх до класса размеров аллокатора,
+// чтобы не терять хвост блока, который аллокатор всё равно выделит. Сетка классов совпадает
+// с jemalloc: кратность 16 байтам до 128 байт, далее 4 класса на каждую степень двойки
+template <typename BasePolicy = DoublingGrowth>
+struct SizeClassGrowth {
+    static size_t RoundUpToSizeClass(size_t bytes) noexcept {
+        if (bytes <= 128) {
+            return (bytes + 15) & ~size_t{15};
+        }
+        size_t lg = 0;
+        for (size_t value = bytes - 1; value > 1; value >>= 1) {
+            ++lg;
+        }
+        const size_t step = size_t{1} << (lg - 2);
+        if (bytes > std::numeric_limits<size_t>::max() - step) {
+            return bytes;
+        }
+        return (bytes + step - 1) & ~(step - 1);
+    }
+
+    template <typename T>
+    static size_t NextCapacity(size_t capacity, size_t min_capacity) noexcept {
+        const size_t new_capacity = BasePolicy::template NextCapacity<T>(capacity, min_capacity);
+        if (new_capacity > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return new_capacity;
+        }
+        return RoundUpToSizeClass(new_capacity * sizeof(T)) / sizeof(T);
+    }
+};
+
+// Политики сбора статистики. Вектор сообщает политике о каждом выделении памяти
+// (OnAllocate) и о каждом переносе элементов в новый буфер (OnRelocate)
+enum class RelocationKind {
+    kBitwise,  // memcpy или reallocate
+    kMove,     // конструктор перемещения
+    kCopy,     // конструктор копирования: перемещение может бросить исключение
+};
+
+// Статистика не собирается. Пустая политика не увеличивает размер вектора
+struct NoVectorStats {
+    void OnAllocate(size_t /*capacity*/, size_t /*bytes*/) noexcept {
+    }
+    void OnRelocate(size_t /*count*/, RelocationKind /*kind*/) noexcept {
+    }
+};
+
+struct VectorStats {
+    void OnAllocate(size_t capacity, size_t bytes) noexcept {
+        ++allocations;
+        allocated_bytes += bytes;
+        peak_capacity = std::max(peak_capacity, capacity);
+    }
+    void OnRelocate(size_t count, RelocationKind kind) noexcept {
+        ++reallocations;
+        switch (kind) {
+        case RelocationKind::kBitwise:
+            relocated_bitwise += count;
+            break;
+        case RelocationKind::kMove:
+            moved_elements += count;
+            break;
+        case RelocationKind::kCopy:
+            copied_elements += count;
+            break;
+        }
+    }
+
+    size_t allocations = 0;
+    size_t allocated_bytes = 0;
+    size_t reallocations = 0;
+    size_t relocated_bitwise = 0;
+    size_t moved_elements = 0;
+    size_t copied_elements = 0;
+    size_t peak_capacity = 0;
+};
+
+// Уровни проверок вектора (CheckPolicy). kBounds включает проверки индексов и позиций
+// в operator[], PopBack, Emplace, Insert и Erase, kIterators — проверяемые итераторы.
+// О нарушении сообщается вызовом Fail(message); noexcept-методы вектора остаются noexcept,
+// только если Fail не бросает исключений
+namespace detail {
+
+[[noreturn]] inline void AbortOnCheckFailure(const char* message) noexcept {
+    std::fprintf(stderr, "Vector check failed: %s\n", message);
+    std::abort();
+}
+
+// Поколение буфера для проверяемых итераторов меняется при каждой замене буфера вектора.
+// Поколения уникальны для всех векторов, так что итератор не примет и чужой буфер,
+// оказавшийся по тому же адресу
+inline size_t NextBufferGeneration() noexcept {
+    static std::atomic<size_t> generation{ 0 };
+    return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+template <bool Enabled>
+struct BufferGeneration {
+    void InvalidateIterators() noexcept {
+    }
+};
+
+template <>
+struct BufferGeneration<true> {
+    BufferGeneration() noexcept = default;
+    BufferGeneration(const BufferGeneration&) noexcept {
+    }
+    BufferGeneration& operator=(const BufferGeneration&) noexcept {
+        return *this;
+    }
+
+    void InvalidateIterators() noexcept {
+        generation = NextBufferGeneration();
+    }
+
+    size_t generation = NextBufferGeneration();
+};
+
+// Сообщает ASan, что в буфере на capacity элементов живы первые new_size элементов
+// вместо old_size: обращения к [new_size, capacity) будут считаться ошибкой
+template <typename T>
+void AnnotateContainer(const T* first, size_t capacity, size_t old_size, size_t new_size) noexcept {
+#if defined(VECTOR_ASAN_ANNOTATIONS)
+    if (capacity != 0 && old_size != new_size) {
+        __sanitizer_annotate_contiguous_container(first, first + capacity, first + old_size, first + new_size);
+    }
+#else
+    static_cast<void>(first);
+    static_cast<void>(capacity);
+    static_cast<void>(old_size);
+    static_cast<void>(new_size);
+#endif
+}
+
+template <typename Storage>
+struct AnnotatesContainer {
+#if defined(VECTOR_ASAN_ANNOTATIONS)
+    static constexpr bool value = is_asan_annotatable<typename Storage::allocator_type>::value;
+#else
+    static constexpr bool value = false;
+#endif
+};
+
+// Векторы, ёмкость которых открыта AnnotationScope в этом потоке. Вложенная область того же
+// вектора ничего не меняет, поэтому разметка не требует полей в самом векторе
+struct AnnotationScopeLink {
+    const void* vector;
+    AnnotationScopeLink* outer;
+
+    static AnnotationScopeLink*& Innermost() noexcept {
+        static thread_local AnnotationScopeLink* innermost = nullptr;
+        return innermost;
+    }
+
+    static bool IsOpen(const void* vector) noexcept {
+        for (const AnnotationScopeLink* link = Innermost(); link != nullptr; link = link->outer) {
+            if (link->vector == vector) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace detail
+
+// Только assert: в сборке с NDEBUG проверок нет
+struct NoVectorChecks {
+    static constexpr bool kBounds = false;
+    static constexpr bool kIterators = false;
+
+    [[noreturn]] static void Fail(const char* message) noexcept {
+        detail::AbortOnCheckFailure(message);
+    }
+};
+
+// Дешёвые проверки, остающиеся в release: индекс или позиция сравниваются с размером,
+// итераторы остаются указателями
+struct HardenedVectorChecks {
+    static constexpr bool kBounds = true;
+    static constexpr bool kIterators = false;
+
+    [[noreturn]] static void Fail(const char* message) noexcept {
+        detail::AbortOnCheckFailure(message);
+    }
+};
+
+// Проверки HardenedVectorChecks и проверяемые итераторы: итератор помнит вектор и поколение
+// его буфера, поэтому разыменование, сдвиг или передача в Insert/Erase итератора, сделанного
+// до перевыделения памяти (а также после Swap или перемещения вектора), выхода за границы
+// или итератора другого вектора обнаруживаются. Итератор нельзя использовать после
+// разрушения вектора
+struct CheckedVectorIterators : HardenedVectorChecks {
+    static constexpr bool kIterators = true;
+};
+
+// Уровень проверок по умолчанию; -DVECTOR_HARDENED включает проверки границ в release
+#if defined(VECTOR_HARDENED)
+using DefaultVectorChecks = HardenedVectorChecks;
+#else
+using DefaultVectorChecks = NoVectorChecks;
+#endif
+
+// Общая часть Vector и его разновидностей: управление элементами поверх хранилища Storage.
+// Хранилище предоставляет GetAddress, Capacity, operator+, operator[], GetAllocator,
+// kCanReallocate/Reallocate и принимает новый буфер через operator=(RawMemory&&).
+// GrowthPolicy выбирает новую ёмкость при вставке в заполненный вектор,
+// StatsPolicy накапливает статистику операций с памятью, CheckPolicy задаёт уровень проверок
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy,
+          typename CheckPolicy = DefaultVectorChecks>
+class VectorBase : private StatsPolicy, private detail::BufferGeneration<CheckPolicy::kIterators> {
+    static constexpr bool kNothrowChecks = noexcept(CheckPolicy::Fail(""));
+    static constexpr bool kAnnotate = detail::AnnotatesContainer<Storage>::value;
+
+    template <bool IsConst>
+    class CheckedIterator;
+
+public:
+    using value_type = T;
+    using allocator_type = typename Storage::allocator_type;
+    using iterator = std::conditional_t<CheckPolicy::kIterators, CheckedIterator<false>, T*>;
+    using const_iterator = std::conditional_t<CheckPolicy::kIterators, CheckedIterator<true>, const T*>;
+
+    iterator begin() noexcept {
+        return MakeIterator<iterator>(0);
+    }
+    iterator end() noexcept {
+        return MakeIterator<iterator>(size_);
+    }
+    const_iterator begin() const noexcept {
+        return MakeIterator<const_iterator>(0);
+    }
+    const_iterator end() const noexcept {
+        return MakeIterator<const_iterator>(size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    const StatsPolicy& GetStats() const noexcept {
+        return *this;
+    }
+
+    VectorView<T> View() noexcept {
+        return VectorView<T>(data_.GetAddress(), size_);
+    }
+    VectorView<const T> View() const noexcept {
+        return VectorView<const T>(data_.GetAddress(), size_);
+    }
+
+    // Элементы [offset, offset + count), см. VectorView::Subview
+    VectorView<T> Subview(size_t offset, size_t count = VectorView<T>::npos) noexcept {
+        return View().Subview(offset, count);
+    }
+    VectorView<const T> Subview(size_t offset, size_t count = VectorView<T>::npos) const noexcept {
+        return View().Subview(offset, count);
+    }
+
+    void Reserve(size_t new_capacity) {
+        AnnotationScope annotations(*this);
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if constexpr (kRelocateBitwise && Storage::kCanReallocate) {
+            data_.Reallocate(new_capacity);
+            RecordAllocation(new_capacity);
+        }
+        else {
+            Memory new_data = AllocateMemory(new_capacity);
+            RelocateTo(new_data.GetAddress());
+            data_ = std::move(new_data);
+        }
+        this->InvalidateIterators();
+        RecordRelocation(size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    void Resize(size_t new_size) {
+        AnnotationScope annotations(*this);
+        if (new_size < size_) {
+            detail::DestroyN(GetAlloc(), data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+            MaybeShrink();
+        }
+        else if (new_size > size_) {
+            Reserve(new_size);
+            detail::UninitializedValueConstructN(GetAlloc(), data_.GetAddress() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    // Как Resize, но новые элементы создаются в нескольких потоках
+    void Resize(ParallelTag tag, size_t new_size) {
+        AnnotationScope annotations(*this);
+        if (new_size <= size_) {
+            Resize(new_size);
+            return;
+        }
+        Reserve(new_size);
+        detail::ParallelInitN(GetAlloc(), data_.GetAddress() + size_, new_size - size_, tag,
+                              [this](T* chunk, size_t, size_t count) {
+            detail::UninitializedValueConstructN(GetAlloc(), chunk, count);
+        });
+        size_ = new_size;
+    }
+
+    // Как Resize, но новые элементы инициализируются по умолчанию: память под тривиальные T
+    // не обнуляется и может быть сразу заполнена, например, через read()/recv()
+    void ResizeUninitialized(size_t new_size) {
+        AnnotationScope annotations(*this);
+        if (new_size < size_) {
+            detail::DestroyN(GetAlloc(), data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+            MaybeShrink();
+        }
+        else if (new_size > size_) {
+            Reserve(new_size);
+            detail::UninitializedDefaultConstructN(GetAlloc(), data_.GetAddress() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return *(Emplace(cend(), std::forward<Args>(args)...));
+    }
+
+    void PopBack() noexcept(kNothrowChecks) {
+        AnnotationScope annotations(*this);
+        Expect(size_ > 0, "PopBack on empty vector");
+        detail::DestroyN(GetAlloc(), data_ + size_ - 1, 1);
+        --size_;
+        MaybeShrink();
+    }
+
+    void Clear() noexcept {
+        AnnotationScope annotations(*this);
+        DestroyAll();
+        MaybeShrink();
+    }
+
+    // Уменьшает ёмкость до размера вектора (или возвращает элементы во встроенный буфер)
+    void ShrinkToFit() {
+        AnnotationScope annotations(*this);
+        if (Capacity() > size_) {
+            ShrinkTo(size_);
+        }
+    }
+
+    // Новый элемент создаётся сразу на своём месте. Если конструктор бросает исключение,
+    // вектор не меняется (для T с бросающим перемещением — только при вставке в конец)
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        AnnotationScope annotations(*this);
+        const size_t dist = IndexOf(pos);
+        if constexpr (!kNothrowShift) {
+            if (dist != size_ && size_ != Capacity()) {
+                EmplaceShiftingByAssignment(dist, std::forward<Args>(args)...);
+                return begin() + dist;
+            }
+        }
+        // Сдвиг хвоста и Reallocate портят аргументы, ссылающиеся на элементы: такой элемент
+        // создаётся заранее. При росте в новый буфер элемент создаётся до переноса старых
+        const bool moves_args = dist != size_ || (kRelocateBitwise && Storage::kCanReallocate && size_ == Capacity());
+        if (moves_args && (detail::PointsInto(args, data_.GetAddress(), size_) || ...)) {
+            T value(std::forward<Args>(args)...);
+            InsertGap(dist, 1, [this, &value](T* gap) {
+                AllocTraits::construct(GetAlloc(), gap, std::move(value));
+            });
+        }
+        else {
+            InsertGap(dist, 1, [&](T* gap) {
+                AllocTraits::construct(GetAlloc(), gap, std::forward<Args>(args)...);
+            });
+        }
+        return begin() + dist;
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t dist = IndexOf(pos);
+        Expect(dist < size_, "Erase at end()");
+        // Хвост отсчитывается от удаляемого элемента: сдвиг не строится для позиции end()
+        T* const erased = data_.GetAddress() + dist;
+        AnnotationScope annotations(*this);
+        std::move(erased + 1, erased + (size_ - dist), erased);
+        detail::DestroyN(GetAlloc(), data_ + size_ - 1, 1);
+        --size_;
+        MaybeShrink();
+        return begin() + dist;
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    iterator Erase(const_iterator first, const_iterator last) {
+        AnnotationScope annotations(*this);
+        const size_t dist = IndexOf(first);
+        const size_t last_index = IndexOf(last);
+        Expect(dist <= last_index, "Erase range is reversed");
+        const size_t count = last_index - dist;
+        if (count != 0) {
+            std::move(data_ + dist + count, data_ + size_, data_ + dist);
+            detail::DestroyN(GetAlloc(), data_ + size_ - count, count);
+            size_ -= count;
+            MaybeShrink();
+        }
+        return begin() + dist;
+    }
+
+    // Удаляет элемент за O(1), перемещая на его место последний элемент. Порядок не сохраняется
+    iterator SwapErase(const_iterator pos) {
+        AnnotationScope annotations(*this);
+        const size_t dist = IndexOf(pos);
+        Expect(dist < size_, "SwapErase at end()");
+        if (dist != size_ - 1) {
+            data_[dist] = std::move(data_[size_ - 1]);
+        }
+        PopBack();
+        return begin() + dist;
     }
 
     iterator Insert(const_iterator pos, const T& value) {
@@ -213,122 +1288,953 @@ public:
         return Emplace(pos, std::move(value));
     }
 
-    ~Vector() {
-        std::destroy_n(data_ + 0, size_);
+    // Вставляет диапазон [first, last), выделяя память и сдвигая хвост не более одного раза.
+    // Диапазон не должен указывать на элементы самого вектора
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        AnnotationScope annotations(*this);
+        const size_t dist = IndexOf(pos);
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            InsertForwardRange(dist, first, static_cast<size_t>(std::distance(first, last)));
+        }
+        else {
+            // Длина однопроходного диапазона заранее неизвестна: дописываем в конец и поворачиваем
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(data_ + dist, data_ + old_size, data_ + size_);
+        }
+        return begin() + dist;
     }
-    
-    const T& operator[](size_t index) const noexcept {
-        return const_cast<Vector&>(*this)[index];
+
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        AnnotationScope annotations(*this);
+        const size_t dist = IndexOf(pos);
+        if (count != 0) {
+            // value может ссылаться на элемент вектора, который будет сдвинут
+            const T copy(value);
+            InsertForwardRange(dist, detail::RepeatIterator<T>(copy, 0), count);
+        }
+        return begin() + dist;
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < size_);
+    iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    void AppendRange(InputIt first, InputIt last) {
+        Insert(cend(), first, last);
+    }
+
+    // Заменяет содержимое вектора элементами [first, last). Память выделяется не более одного раза
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    void Assign(InputIt first, InputIt last) {
+        AnnotationScope annotations(*this);
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            AssignForwardRange(first, static_cast<size_t>(std::distance(first, last)));
+        }
+        else {
+            detail::DestroyN(GetAlloc(), data_.GetAddress(), size_);
+            size_ = 0;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    void Assign(size_t count, const T& value) {
+        AnnotationScope annotations(*this);
+        const T copy(value);
+        AssignForwardRange(detail::RepeatIterator<T>(copy, 0), count);
+    }
+
+    void Assign(std::initializer_list<T> values) {
+        Assign(values.begin(), values.end());
+    }
+
+    const T& operator[](size_t index) const noexcept(kNothrowChecks) {
+        return const_cast<VectorBase&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept(kNothrowChecks) {
+        Expect(index < size_, "vector index out of range");
         return data_[index];
     }
 
-    Vector& operator=(const Vector& rhs) {
-        if (this != &rhs) {
-            if (rhs.size_ > data_.Capacity()) {
-                Vector rhs_copy(rhs);
-                Swap(rhs_copy);
+protected:
+    using AllocTraits = std::allocator_traits<allocator_type>;
+    using Memory = RawMemory<T, allocator_type>;
+    static constexpr bool kRelocateBitwise = detail::kRelocateBitwise<T, allocator_type>;
+
+    VectorBase() = default;
+
+    template <typename... StorageArgs>
+    explicit VectorBase(std::in_place_t, StorageArgs&&... storage_args)
+        : data_(std::forward<StorageArgs>(storage_args)...) {
+    }
+
+    VectorBase(const VectorBase&) = delete;
+    VectorBase& operator=(const VectorBase&) = delete;
+
+    ~VectorBase() {
+        AnnotateSize(size_, Capacity());
+        detail::DestroyN(GetAlloc(), data_ + 0, size_);
+    }
+
+    // Под ASan ёмкость за концом вектора недоступна. Метод, который пишет в неё или меняет
+    // размер и буфер, открывает её на время работы; при выходе из внешней области
+    // [Size(), Capacity()) текущего буфера снова помечается недоступной, в том числе при исключении
+    class AnnotationScope {
+    public:
+        explicit AnnotationScope(VectorBase& vector) noexcept
+            : vector_(vector) {
+            if constexpr (kAnnotate) {
+                if (!detail::AnnotationScopeLink::IsOpen(&vector_)) {
+                    vector_.AnnotateSize(vector_.size_, vector_.Capacity());
+                    link_ = { &vector_, detail::AnnotationScopeLink::Innermost() };
+                    detail::AnnotationScopeLink::Innermost() = &link_;
+                    outermost_ = true;
+                }
             }
-        else {
-                if (Size() > rhs.Size()) {
-                    for (size_t i = 0; i < rhs.size_; ++i)
-                    {
-                        data_[i] = std::move(rhs.data_[i]);
-                    }
-                    std::destroy_n(data_ + rhs.Size(), Size() - rhs.Size());
+        }
+
+        AnnotationScope(const AnnotationScope&) = delete;
+        AnnotationScope& operator=(const AnnotationScope&) = delete;
+
+        ~AnnotationScope() {
+            if constexpr (kAnnotate) {
+                if (outermost_) {
+                    detail::AnnotationScopeLink::Innermost() = link_.outer;
+                    vector_.AnnotateSize(vector_.Capacity(), vector_.size_);
                 }
-                else {
-                    for (size_t i = 0; i < size_; ++i)
-                    {
-                        data_[i] = std::move(rhs.data_[i]);
-                    }
-                    std::uninitialized_copy_n(rhs.data_ + Size(), rhs.Size() - Size(), data_.GetAddress() + size_);
+            }
+        }
+
+    private:
+        [[maybe_unused]] VectorBase& vector_;
+        [[maybe_unused]] detail::AnnotationScopeLink link_{};
+        [[maybe_unused]] bool outermost_ = false;
+    };
+
+    // Встроенный буфер делит гранулы с соседними полями объекта, поэтому размечается только
+    // память аллокатора
+    void AnnotateSize(size_t old_size, size_t new_size) const noexcept {
+        if constexpr (kAnnotate) {
+            if constexpr (detail::InlineCapacity<Storage>::value != 0) {
+                if (data_.IsInline()) {
+                    return;
                 }
             }
+            detail::AnnotateContainer(data_.GetAddress(), Capacity(), old_size, new_size);
+        }
+        else {
+            static_cast<void>(old_size);
+            static_cast<void>(new_size);
         }
-        size_ = rhs.Size();
-        return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
-        if (this != &rhs) {
-            if (rhs.Size() > data_.Capacity()) {
-                Swap(rhs);
-            }
-            else {
-                data_.Swap(rhs.data_);
-                size_ = rhs.Size();
+    allocator_type& GetAlloc() noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Замена буфера делает недействительными все проверяемые итераторы вектора
+    void InvalidateIterators() noexcept {
+        detail::BufferGeneration<CheckPolicy::kIterators>::InvalidateIterators();
+    }
+
+    static void Expect(bool condition, const char* message) noexcept(kNothrowChecks) {
+        if constexpr (CheckPolicy::kBounds) {
+            if (!condition) {
+                CheckPolicy::Fail(message);
             }
         }
-        return *this;
+        else {
+            assert(condition);
+            static_cast<void>(condition);
+            static_cast<void>(message);
+        }
     }
 
-    void Swap(Vector& other) noexcept {
-        data_.Swap(other.data_);
-        std::swap(size_, other.size_);
+    // Индекс позиции pos, которая должна лежать в [begin(), end()]
+    size_t IndexOf(const_iterator pos) const noexcept(kNothrowChecks) {
+        const T* ptr = nullptr;
+        if constexpr (CheckPolicy::kIterators) {
+            pos.ExpectValid(this);
+            ptr = pos.ptr_;
+        }
+        else {
+            ptr = pos;
+        }
+        const std::less<const T*> less;
+        Expect(!less(ptr, data_.GetAddress()) && !less(data_.GetAddress() + size_, ptr), "vector position out of range");
+        return static_cast<size_t>(ptr - data_.GetAddress());
     }
 
-private:
-    RawMemory<T> data_;
-    size_t size_ = 0;
+    template <typename It>
+    It MakeIterator(size_t index) const noexcept {
+        T* ptr = const_cast<VectorBase&>(*this).data_.GetAddress() + index;
+        if constexpr (CheckPolicy::kIterators) {
+            return It(this, ptr);
+        }
+        else {
+            return ptr;
+        }
+    }
 
-    template <typename... Args>
-    void EmplaceWithEmptyCapacity(size_t distance, Args&&... args) {
-        new(end()) T(std::forward<T>(data_[size_ - 1]));
-        T tmp(std::forward<Args>(args)...);
-        std::move_backward(begin() + distance, end() - 1, end());
-        *(data_ + distance) = std::move(tmp);
+    // Разрушает все элементы, не меняя ёмкость
+    void DestroyAll() noexcept {
+        detail::DestroyN(GetAlloc(), data_.GetAddress(), size_);
+        size_ = 0;
     }
 
-    template <typename... Args>
-    void EmplaceWhithFullCapacity(size_t distance, Args&&... args) {
-        size_t new_capacity = size_ == 0 ? 1 : Capacity() * 2;
-        RawMemory<T> new_data(new_capacity);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
-        {
-            std::uninitialized_move_n(data_.GetAddress(), distance, new_data.GetAddress());
-            new(new_data + distance) T(std::forward<Args>(args)...);
-            std::uninitialized_move_n(data_.GetAddress() + distance, size_ - distance, new_data.GetAddress() + distance + 1);
-        }
-        else
-        {
+    // Политика может отказать в росте исключением (как у StaticVector)
+    size_t NextCapacity(size_t min_capacity) const noexcept(noexcept(GrowthPolicy::template NextCapacity<T>(0, 0))) {
+        return GrowthPolicy::template NextCapacity<T>(Capacity(), min_capacity);
+    }
+
+    Memory AllocateMemory(size_t capacity) {
+        Memory memory(capacity, data_.GetAllocator());
+        RecordAllocation(capacity);
+        return memory;
+    }
+
+    void RecordAllocation(size_t capacity) noexcept {
+        if (capacity != 0) {
+            StatsPolicy::OnAllocate(capacity, capacity * sizeof(T));
+        }
+    }
+
+    // Учитывает перенос count элементов способом, который используется для T
+    void RecordRelocation(size_t count) noexcept {
+        if (count == 0) {
+            return;
+        }
+        if constexpr (kRelocateBitwise) {
+            StatsPolicy::OnRelocate(count, RelocationKind::kBitwise);
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            StatsPolicy::OnRelocate(count, RelocationKind::kMove);
+        }
+        else {
+            StatsPolicy::OnRelocate(count, RelocationKind::kCopy);
+        }
+    }
+
+    // Копирует элементы rhs. Если ёмкости не хватает, память выделяется один раз под rhs.Size()
+    // элементов, а старые элементы не переносятся, так как всё равно были бы перезаписаны
+    void AssignCopy(const VectorBase& rhs) {
+        AnnotationScope annotations(*this);
+        if constexpr (kRelocateBitwise && Storage::kCanReallocate) {
+            GrowInPlace(rhs.size_);
+        }
+        if (rhs.size_ > Capacity()) {
+            Memory new_data = AllocateMemory(rhs.size_);
+            detail::UninitializedCopyN(GetAlloc(), rhs.data_.GetAddress(), rhs.size_, new_data.GetAddress());
+            DestroyAll();
+            data_ = std::move(new_data);
+            this->InvalidateIterators();
+        }
+        else if (Size() > rhs.Size()) {
+            std::copy_n(rhs.data_.GetAddress(), rhs.size_, data_.GetAddress());
+            detail::DestroyN(GetAlloc(), data_ + rhs.Size(), Size() - rhs.Size());
+        }
+        else {
+            std::copy_n(rhs.data_.GetAddress(), size_, data_.GetAddress());
+            detail::UninitializedCopyN(GetAlloc(), rhs.data_ + Size(), rhs.Size() - Size(), data_.GetAddress() + size_);
+        }
+        size_ = rhs.Size();
+    }
+
+    Storage data_;
+    size_t size_ = 0;
+
+private:
+    // Сдвиг хвоста на свободные места не бросает исключений
+    static constexpr bool kNothrowShift = kRelocateBitwise || std::is_nothrow_move_constructible_v<T>;
+
+    // Единственный путь вставки count элементов перед позицией dist. build(gap) создаёт их
+    // в неинициализированной памяти [gap, gap + count) и сам разрушает созданные при исключении.
+    // При нехватке ёмкости новые элементы создаются в новом буфере, а старые переносятся вокруг них
+    // один раз (копируются, если перемещение может бросить). Иначе хвост сдвигается на свободные
+    // места, а при исключении в build возвращается обратно. В обоих случаях исключение
+    // оставляет вектор прежним
+    template <typename Build>
+    void InsertGap(size_t dist, size_t count, Build build) {
+        if constexpr (kRelocateBitwise && Storage::kCanReallocate) {
+            if (size_ + count > Capacity()) {
+                GrowInPlace(NextCapacity(size_ + count));
+            }
+        }
+        if constexpr (detail::IsFixedCapacity<Storage>::value) {
+            if (size_ + count > Capacity()) {
+                throw std::length_error("vector capacity exceeded");
+            }
+        }
+        else if (size_ + count > Capacity()) {
+            Memory new_data = AllocateMemory(NextCapacity(size_ + count));
+            T* gap = new_data + dist;
+            build(gap);
             try {
-                std::uninitialized_copy_n(data_.GetAddress(), distance, new_data.GetAddress());
+                RelocateAround(new_data, dist, count);
             }
             catch (...) {
+                detail::DestroyN(GetAlloc(), gap, count);
                 throw;
             }
+            RecordRelocation(size_);
+            data_ = std::move(new_data);
+            this->InvalidateIterators();
+            size_ += count;
+            return;
+        }
 
-            try
-            {
-                new(new_data + distance) T(std::forward<Args>(args)...);
+        if constexpr (kNothrowShift) {
+            ShiftTail(dist, count);
+            try {
+                build(data_ + dist);
             }
             catch (...) {
+                UnshiftTail(dist, count);
                 throw;
             }
+            size_ += count;
+        }
+        else {
+            // Сдвиг с бросающим перемещением нельзя откатить: такие вставки сюда не попадают
+            assert(dist == size_);
+            build(data_ + dist);
+            size_ += count;
+        }
+    }
+
+    // Переносит элементы [dist, size_) на count позиций вправо, оставляя на их месте
+    // неинициализированную память
+    void ShiftTail(size_t dist, size_t count) noexcept {
+        T* pos = data_ + dist;
+        const size_t tail = size_ - dist;
+        if constexpr (kRelocateBitwise) {
+            std::memmove(static_cast<void*>(pos + count), pos, tail * sizeof(T));
+        }
+        else {
+            for (size_t i = tail; i > 0; --i) {
+                AllocTraits::construct(GetAlloc(), pos + count + i - 1, std::move(pos[i - 1]));
+                AllocTraits::destroy(GetAlloc(), pos + i - 1);
+            }
+        }
+    }
+
+    // Возвращает хвост, сдвинутый ShiftTail, на место
+    void UnshiftTail(size_t dist, size_t count) noexcept {
+        T* pos = data_ + dist;
+        const size_t tail = size_ - dist;
+        if constexpr (kRelocateBitwise) {
+            std::memmove(static_cast<void*>(pos), pos + count, tail * sizeof(T));
+        }
+        else {
+            for (size_t i = 0; i < tail; ++i) {
+                AllocTraits::construct(GetAlloc(), pos + i, std::move(pos[count + i]));
+                AllocTraits::destroy(GetAlloc(), pos + count + i);
+            }
+        }
+    }
 
+    // Вставка в середину без роста для T с бросающим перемещением: сдвиг хвоста нельзя
+    // откатить, поэтому элемент создаётся заранее, а хвост сдвигается присваиванием, как
+    // в std::vector. Исключение при сдвиге оставляет все элементы живыми (базовая гарантия)
+    template <typename... Args>
+    void EmplaceShiftingByAssignment(size_t dist, Args&&... args) {
+        T value(std::forward<Args>(args)...);
+        AllocTraits::construct(GetAlloc(), data_ + size_, std::move(data_[size_ - 1]));
+        ++size_;
+        std::move_backward(data_ + dist, data_ + size_ - 2, data_ + size_ - 1);
+        data_[dist] = std::move(value);
+    }
+
+    template <typename ForwardIt>
+    void InsertForwardRange(size_t dist, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (kNothrowShift || size_ + count > Capacity()) {
+            InsertGap(dist, count, [this, &first, count](T* gap) {
+                detail::UninitializedCopyFromN(GetAlloc(), first, count, gap);
+            });
+            return;
+        }
+
+        // Хвост T с бросающим перемещением сдвигается присваиванием (базовая гарантия)
+        T* pos = data_ + dist;
+        T* old_end = data_ + size_;
+        const size_t tail = size_ - dist;
+        if (count <= tail) {
+            detail::UninitializedMoveN(GetAlloc(), old_end - count, count, old_end);
+            size_ += count;
+            std::move_backward(pos, old_end - count, old_end);
+            std::copy_n(first, count, pos);
+        }
+        else {
+            ForwardIt mid = std::next(first, tail);
+            detail::UninitializedCopyFromN(GetAlloc(), mid, count - tail, old_end);
             try {
-                std::uninitialized_copy_n(data_.GetAddress() + distance, size_ - distance, new_data.GetAddress() + distance + 1);
+                detail::UninitializedMoveN(GetAlloc(), pos, tail, old_end + (count - tail));
             }
             catch (...) {
+                detail::DestroyN(GetAlloc(), old_end, count - tail);
                 throw;
             }
+            size_ += count;
+            std::copy(first, mid, pos);
         }
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
     }
 
-    void MoveOrCopyRawMemory(RawMemory<T>& other) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
-        {
-            std::uninitialized_move_n(data_.GetAddress(), size_, other.GetAddress());
+    template <typename ForwardIt>
+    void AssignForwardRange(ForwardIt first, size_t count) {
+        if constexpr (kRelocateBitwise && Storage::kCanReallocate) {
+            GrowInPlace(count);
         }
-        else
-        {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, other.GetAddress());
+        if (count > Capacity()) {
+            Memory new_data = AllocateMemory(count);
+            detail::UninitializedCopyFromN(GetAlloc(), first, count, new_data.GetAddress());
+            detail::DestroyN(GetAlloc(), data_.GetAddress(), size_);
+            data_ = std::move(new_data);
+            this->InvalidateIterators();
         }
+        else if (count <= size_) {
+            std::copy_n(first, count, data_.GetAddress());
+            detail::DestroyN(GetAlloc(), data_ + count, size_ - count);
+        }
+        else {
+            ForwardIt mid = std::next(first, size_);
+            std::copy(first, mid, data_.GetAddress());
+            detail::UninitializedCopyFromN(GetAlloc(), mid, count - size_, data_ + size_);
+        }
+        size_ = count;
+    }
+
+    // Увеличивает ёмкость через Reallocate, сохраняя элементы. Хранилище с kCanReallocate
+    // (например, отображённый в память файл) никогда не получает второй буфер одновременно с первым
+    void GrowInPlace(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            data_.Reallocate(new_capacity);
+            this->InvalidateIterators();
+            RecordAllocation(new_capacity);
+            RecordRelocation(size_);
+        }
+    }
+
+    // Переносит элементы в new_data, оставляя после первых dist элементов промежуток
+    // из gap ячеек, и разрушает исходные объекты
+    void RelocateAround(Memory& new_data, size_t dist, size_t gap) {
+        if constexpr (kRelocateBitwise) {
+            if (size_ != 0) {
+                std::memcpy(static_cast<void*>(new_data.GetAddress()), data_.GetAddress(), dist * sizeof(T));
+                std::memcpy(static_cast<void*>(new_data + dist + gap), data_ + dist, (size_ - dist) * sizeof(T));
+            }
+        }
+        else {
+            detail::UninitializedMoveIfNoexceptN(GetAlloc(), data_.GetAddress(), dist, new_data.GetAddress());
+            try {
+                detail::UninitializedMoveIfNoexceptN(GetAlloc(), data_ + dist, size_ - dist, new_data + dist + gap);
+            }
+            catch (...) {
+                detail::DestroyN(GetAlloc(), new_data.GetAddress(), dist);
+                throw;
+            }
+            detail::DestroyN(GetAlloc(), data_.GetAddress(), size_);
+        }
+    }
+
+    // Переносит элементы в dest и разрушает исходные объекты
+    void RelocateTo(T* dest) {
+        if constexpr (kRelocateBitwise) {
+            if (size_ != 0) {
+                std::memcpy(static_cast<void*>(dest), data_.GetAddress(), size_ * sizeof(T));
+            }
+        }
+        else {
+            detail::UninitializedMoveIfNoexceptN(GetAlloc(), data_.GetAddress(), size_, dest);
+            detail::DestroyN(GetAlloc(), data_.GetAddress(), size_);
+        }
+    }
+
+    void ShrinkTo(size_t new_capacity) {
+        assert(new_capacity >= size_ && new_capacity < Capacity());
+        constexpr size_t kInlineCapacity = detail::InlineCapacity<Storage>::value;
+        if constexpr (kInlineCapacity != 0) {
+            if (new_capacity <= kInlineCapacity) {
+                if (!data_.IsInline()) {
+                    RelocateTo(data_.GetInlineAddress());
+                    data_ = Memory(data_.GetAllocator());
+                    this->InvalidateIterators();
+                    RecordRelocation(size_);
+                }
+                return;
+            }
+        }
+        if constexpr (kRelocateBitwise && Storage::kCanReallocate) {
+            if (new_capacity == 0) {
+                data_ = Memory(data_.GetAllocator());
+            }
+            else {
+                // Аллокатор может уменьшить блок на месте
+                data_.Reallocate(new_capacity);
+                RecordAllocation(new_capacity);
+            }
+        }
+        else {
+            Memory new_data = AllocateMemory(new_capacity);
+            RelocateTo(new_data.GetAddress());
+            data_ = std::move(new_data);
+        }
+        this->InvalidateIterators();
+        RecordRelocation(size_);
+    }
+
+    void MaybeShrink() noexcept {
+        if constexpr (detail::HasShrinkCapacity<GrowthPolicy, T>::value) {
+            const size_t new_capacity = GrowthPolicy::template ShrinkCapacity<T>(Capacity(), size_);
+            if (new_capacity < Capacity()) {
+                try {
+                    ShrinkTo(std::max(new_capacity, size_));
+                }
+                catch (...) {
+                    // Уменьшение ёмкости - лишь оптимизация, при нехватке памяти вектор остаётся прежним
+                }
+            }
+        }
+    }
+
+    size_t Generation() const noexcept {
+        return this->generation;
     }
 };
+
+// Итератор вектора с CheckPolicy::kIterators. Каждая операция проверяет, что буфер вектора
+// не заменялся с момента создания итератора и что итератор не выходит за [begin(), end()]
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+template <bool IsConst>
+class VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>::CheckedIterator {
+    friend class VectorBase;
+    friend class CheckedIterator<!IsConst>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+
+    CheckedIterator() = default;
+
+    template <bool OtherConst, std::enable_if_t<IsConst && !OtherConst, int> = 0>
+    CheckedIterator(const CheckedIterator<OtherConst>& other) noexcept
+        : owner_(other.owner_)
+        , ptr_(other.ptr_)
+        , generation_(other.generation_) {
+    }
+
+    reference operator*() const noexcept(kNothrowChecks) {
+        return (*this)[0];
+    }
+
+    pointer operator->() const noexcept(kNothrowChecks) {
+        return &(*this)[0];
+    }
+
+    reference operator[](difference_type offset) const noexcept(kNothrowChecks) {
+        const difference_type index = Index() + offset;
+        Expect(index >= 0 && static_cast<size_t>(index) < owner_->size_, "vector iterator is not dereferenceable");
+        return ptr_[offset];
+    }
+
+    CheckedIterator& operator+=(difference_type offset) noexcept(kNothrowChecks) {
+        const difference_type index = Index() + offset;
+        Expect(index >= 0 && static_cast<size_t>(index) <= owner_->size_, "vector iterator moved out of range");
+        ptr_ += offset;
+        return *this;
+    }
+
+    CheckedIterator& operator-=(difference_type offset) noexcept(kNothrowChecks) {
+        return *this += -offset;
+    }
+
+    CheckedIterator& operator++() noexcept(kNothrowChecks) {
+        return *this += 1;
+    }
+
+    CheckedIterator operator++(int) noexcept(kNothrowChecks) {
+        CheckedIterator old = *this;
+        *this += 1;
+        return old;
+    }
+
+    CheckedIterator& operator--() noexcept(kNothrowChecks) {
+        return *this -= 1;
+    }
+
+    CheckedIterator operator--(int) noexcept(kNothrowChecks) {
+        CheckedIterator old = *this;
+        *this -= 1;
+        return old;
+    }
+
+    friend CheckedIterator operator+(CheckedIterator it, difference_type offset) noexcept(kNothrowChecks) {
+        return it += offset;
+    }
+
+    friend CheckedIterator operator+(difference_type offset, CheckedIterator it) noexcept(kNothrowChecks) {
+        return it += offset;
+    }
+
+    friend CheckedIterator operator-(CheckedIterator it, difference_type offset) noexcept(kNothrowChecks) {
+        return it -= offset;
+    }
+
+    // Сравнивать и вычитать можно только итераторы одного вектора
+    template <bool OtherConst>
+    difference_type operator-(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        ExpectComparable(other);
+        return ptr_ - other.ptr_;
+    }
+
+    template <bool OtherConst>
+    bool operator==(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        ExpectComparable(other);
+        return ptr_ == other.ptr_;
+    }
+
+    template <bool OtherConst>
+    bool operator!=(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        return !(*this == other);
+    }
+
+    template <bool OtherConst>
+    bool operator<(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        return *this - other < 0;
+    }
+
+    template <bool OtherConst>
+    bool operator>(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        return *this - other > 0;
+    }
+
+    template <bool OtherConst>
+    bool operator<=(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        return *this - other <= 0;
+    }
+
+    template <bool OtherConst>
+    bool operator>=(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        return *this - other >= 0;
+    }
+
+private:
+    CheckedIterator(const VectorBase* owner, T* ptr) noexcept
+        : owner_(owner)
+        , ptr_(ptr)
+        , generation_(owner->Generation()) {
+    }
+
+    void ExpectValid(const VectorBase* owner) const noexcept(kNothrowChecks) {
+        Expect(owner_ == owner, "iterator belongs to another vector");
+        Expect(generation_ == owner->Generation(), "vector iterator invalidated by reallocation");
+    }
+
+    template <bool OtherConst>
+    void ExpectComparable(const CheckedIterator<OtherConst>& other) const noexcept(kNothrowChecks) {
+        Expect(owner_ == other.owner_, "comparing iterators of different vectors");
+    }
+
+    // Позиция итератора в векторе после проверки, что он ещё действителен
+    difference_type Index() const noexcept(kNothrowChecks) {
+        Expect(owner_ != nullptr, "singular vector iterator");
+        ExpectValid(owner_);
+        return ptr_ - owner_->data_.GetAddress();
+    }
+
+    const VectorBase* owner_ = nullptr;
+    pointer ptr_ = nullptr;
+    size_t generation_ = 0;
+};
+
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename StatsPolicy = NoVectorStats, typename CheckPolicy = DefaultVectorChecks>
+class Vector : public VectorBase<T, RawMemory<T, Allocator>, GrowthPolicy, StatsPolicy, CheckPolicy> {
+    using Base = VectorBase<T, RawMemory<T, Allocator>, GrowthPolicy, StatsPolicy, CheckPolicy>;
+    using typename Base::AllocTraits;
+    using Base::data_;
+    using Base::size_;
+    using Base::GetAlloc;
+
+public:
+    Vector() = default;
+
+    explicit Vector(const Allocator& alloc) noexcept
+        : Base(std::in_place, alloc) {
+    }
+
+    explicit Vector(size_t size, const Allocator& alloc = Allocator())
+        : Base(std::in_place, size, alloc)
+    {
+        this->RecordAllocation(size);
+        detail::UninitializedValueConstructN(GetAlloc(), data_.GetAddress(), size);
+        size_ = size;
+    }
+
+    Vector(size_t size, DefaultInitTag, const Allocator& alloc = Allocator())
+        : Base(std::in_place, size, alloc)
+    {
+        this->RecordAllocation(size);
+        detail::UninitializedDefaultConstructN(GetAlloc(), data_.GetAddress(), size);
+        size_ = size;
+    }
+
+    Vector(size_t size, const T& value, const Allocator& alloc = Allocator())
+        : Base(std::in_place, alloc)
+    {
+        this->Assign(size, value);
+    }
+
+    // Создание элементов в нескольких потоках, см. ParallelTag
+    Vector(ParallelTag tag, size_t size, const Allocator& alloc = Allocator())
+        : Base(std::in_place, size, alloc)
+    {
+        this->RecordAllocation(size);
+        detail::ParallelInitN(GetAlloc(), data_.GetAddress(), size, tag, [this](T* chunk, size_t, size_t count) {
+            detail::UninitializedValueConstructN(GetAlloc(), chunk, count);
+        });
+        size_ = size;
+    }
+
+    Vector(ParallelTag tag, size_t size, const T& value, const Allocator& alloc = Allocator())
+        : Base(std::in_place, size, alloc)
+    {
+        this->RecordAllocation(size);
+        detail::ParallelInitN(GetAlloc(), data_.GetAddress(), size, tag, [this, &value](T* chunk, size_t, size_t count) {
+            detail::UninitializedInitN(GetAlloc(), chunk, count, [this, &value](T* place, size_t) {
+                AllocTraits::construct(GetAlloc(), place, value);
+            });
+        });
+        size_ = size;
+    }
+
+    // Копирование в нескольких потоках
+    Vector(ParallelTag tag, const Vector& other)
+        : Base(std::in_place, other.size_,
+               AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+    {
+        this->RecordAllocation(other.size_);
+        const T* src = other.data_.GetAddress();
+        detail::ParallelInitN(GetAlloc(), data_.GetAddress(), other.size_, tag,
+                              [this, src](T* chunk, size_t offset, size_t count) {
+            detail::UninitializedCopyN(GetAlloc(), src + offset, count, chunk);
+        });
+        size_ = other.size_;
+    }
+
+    template <typename InputIt, detail::EnableIfInputIterator<InputIt> = 0>
+    Vector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : Base(std::in_place, alloc)
+    {
+        this->Assign(first, last);
+    }
+
+    Vector(std::initializer_list<T> values, const Allocator& alloc = Allocator())
+        : Vector(values.begin(), values.end(), alloc)
+    {
+    }
+
+    Vector(const Vector & other)
+        : Vector(other, other.size_, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+    {
+    }
+
+    // Копия с ёмкостью не меньше capacity, позволяющая дополнять её без перевыделений
+    Vector(const Vector& other, size_t capacity)
+        : Vector(other, std::max(capacity, other.size_),
+                 AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+    {
+    }
+
+    Vector(Vector&& other) noexcept
+        : Base(std::in_place, std::move(other.data_))
+    {
+        size_ = std::exchange(other.size_, 0);
+        other.InvalidateIterators();
+    }
+
+    // Конструкторы с явным аллокатором нужны и для uses-allocator construction,
+    // например когда Vector лежит в векторе с std::pmr::polymorphic_allocator
+    Vector(const Vector& other, const Allocator& alloc)
+        : Vector(other, other.size_, alloc)
+    {
+    }
+
+    Vector(Vector&& other, const Allocator& alloc)
+        : Base(std::in_place, alloc)
+    {
+        if (data_.GetAllocator() == other.data_.GetAllocator()) {
+            data_.Swap(other.data_);
+            size_ = std::exchange(other.size_, 0);
+            other.InvalidateIterators();
+        }
+        else {
+            typename Base::AnnotationScope annotations(*this);
+            this->Reserve(other.size_);
+            detail::UninitializedMoveN(GetAlloc(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+            size_ = other.size_;
+        }
+    }
+
+    Vector& operator=(const Vector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                // Память, выделенную чужим аллокатором, нельзя оставлять у нового
+                if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    ReleaseStorage();
+                }
+                data_.GetAllocator() = rhs.data_.GetAllocator();
+            }
+            this->AssignCopy(rhs);
+        }
+        return *this;
+    }
+
+    Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value) {
+                StealStorage(rhs);
+            }
+            else if (data_.GetAllocator() == rhs.data_.GetAllocator()) {
+                StealStorage(rhs);
+            }
+            else {
+                // Чужой буфер забрать нельзя - перемещаем элементы в память своего аллокатора
+                Vector tmp(data_.GetAllocator());
+                {
+                    typename Base::AnnotationScope annotations(tmp);
+                    tmp.Reserve(rhs.size_);
+                    detail::UninitializedMoveN(tmp.GetAlloc(), rhs.data_.GetAddress(), rhs.size_, tmp.data_.GetAddress());
+                    tmp.size_ = rhs.size_;
+                }
+                Swap(tmp);
+            }
+        }
+        return *this;
+    }
+
+    // В отличие от std::vector, проверяемые итераторы обоих векторов становятся недействительными
+    void Swap(Vector& other) noexcept {
+        assert(AllocTraits::propagate_on_container_swap::value
+               || data_.GetAllocator() == other.data_.GetAllocator());
+        data_.Swap(other.data_);
+        std::swap(size_, other.size_);
+        this->InvalidateIterators();
+        other.InvalidateIterators();
+    }
+
+    // Создаёт вектор поверх готового буфера без копирования. Буфер должен быть выделен
+    // через AllocTraits::allocate(alloc, capacity), а первые size его элементов — созданы.
+    // Например, буфер, полученный от malloc, можно принять в Vector<T, MallocAllocator<T>>
+    static Vector Adopt(T* buffer, size_t size, size_t capacity, const Allocator& alloc = Allocator()) noexcept {
+        assert(size <= capacity && (buffer != nullptr || capacity == 0));
+        Vector result(alloc);
+        typename Base::AnnotationScope annotations(result);
+        result.data_ = RawMemory<T, Allocator>(buffer, capacity, alloc);
+        result.size_ = size;
+        return result;
+    }
+
+    static Vector Adopt(VectorBuffer<T, Allocator>&& buffer) noexcept {
+        Vector result(buffer.memory_.GetAllocator());
+        typename Base::AnnotationScope annotations(result);
+        result.data_ = std::move(buffer.memory_);
+        result.size_ = std::exchange(buffer.size_, 0);
+        return result;
+    }
+
+    // Забирает буфер вместе с элементами, оставляя вектор пустым
+    VectorBuffer<T, Allocator> Release() noexcept {
+        typename Base::AnnotationScope annotations(*this);
+        RawMemory<T, Allocator> empty(data_.GetAllocator());
+        data_.Swap(empty);
+        this->InvalidateIterators();
+        return VectorBuffer<T, Allocator>(std::move(empty), std::exchange(size_, 0));
+    }
+
+private:
+    Vector(const Vector& other, size_t capacity, const Allocator& alloc)
+        : Base(std::in_place, capacity, alloc)
+    {
+        typename Base::AnnotationScope annotations(*this);
+        this->RecordAllocation(capacity);
+        detail::UninitializedCopyN(GetAlloc(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+        size_ = other.size_;
+    }
+
+    // Разрушает элементы и освобождает память, не меняя аллокатор
+    void ReleaseStorage() noexcept {
+        typename Base::AnnotationScope annotations(*this);
+        this->DestroyAll();
+        RawMemory<T, Allocator> empty(data_.GetAllocator());
+        data_.Swap(empty);
+        this->InvalidateIterators();
+    }
+
+    void StealStorage(Vector& rhs) noexcept {
+        typename Base::AnnotationScope annotations(*this);
+        detail::DestroyN(GetAlloc(), data_.GetAddress(), size_);
+        data_ = std::move(rhs.data_);
+        size_ = std::exchange(rhs.size_, 0);
+        this->InvalidateIterators();
+        rhs.InvalidateIterators();
+    }
+};
+
+// Удаляет все элементы, удовлетворяющие pred, за один проход с сохранением порядка.
+// Возвращает число удалённых элементов
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy,
+          typename Predicate>
+size_t EraseIf(VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& vector, Predicate pred) {
+    const auto new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t removed = std::distance(new_end, vector.end());
+    vector.Erase(new_end, vector.cend());
+    return removed;
+}
+
+// То же, что EraseIf, но порядок не сохраняется: удалённые элементы замещаются элементами
+// с конца вектора, поэтому перемещается не больше элементов, чем удаляется
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy,
+          typename Predicate>
+size_t UnorderedEraseIf(VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& vector, Predicate pred) {
+    auto first = vector.begin();
+    auto last = vector.end();
+    while (true) {
+        while (first != last && !pred(*first)) {
+            ++first;
+        }
+        if (first == last) {
+            break;
+        }
+        do {
+            --last;
+        } while (first != last && pred(*last));
+        if (first == last) {
+            break;
+        }
+        *first = std::move(*last);
+        ++first;
+    }
+    const size_t removed = std::distance(first, vector.end());
+    vector.Erase(first, vector.cend());
+    return removed;
+}
+
+// Вектор с буфером, выровненным по Alignment байт и дополненным до кратного PadTo байт
+template <typename T, size_t Alignment = 64, size_t PadTo = Alignment>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment, PadTo>>;
@@ -0,0 +1,342 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#include <unistd.h>
+#define VECTOR_IO_HAS_FD 1
+#endif
+
+// Двоичный формат вектора тривиально копируемых элементов: 48-байтный заголовок, за которым
+// без промежутков лежат байты элементов в том виде, в каком они хранятся в памяти.
+// Порядок байт не преобразуется: файл, записанный на машине с другим порядком, отвергается
+struct VectorIoHeader {
+    static constexpr uint64_t kMagic = 0x314F494345564441;  // "ADVECIO1"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kEndianMark = 0x01020304;
+    static constexpr uint32_t kHasChecksum = 1;
+
+    uint64_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t endian_mark = kEndianMark;
+    uint64_t element_size = 0;
+    uint64_t size = 0;
+    uint64_t checksum = 0;
+    uint32_t flags = 0;
+    uint32_t reserved = 0;
+};
+static_assert(sizeof(VectorIoHeader) == 48 && std::is_trivially_copyable_v<VectorIoHeader>);
+
+struct VectorIoOptions {
+    // Контрольная сумма требует лишнего прохода по элементам при записи
+    bool checksum = true;
+};
+
+namespace detail {
+
+// Потоковая 64-битная контрольная сумма: четыре независимые полосы по 8 байт, чтобы умножения
+// не выстраивались в одну цепочку зависимостей. Результат не зависит от разбиения входа на порции
+class VectorChecksum {
+public:
+    void Update(const void* data, size_t bytes) noexcept {
+        auto* p = static_cast<const unsigned char*>(data);
+        if (pending_ != 0) {
+            const size_t n = std::min(bytes, kBlockSize - pending_);
+            std::memcpy(block_ + pending_, p, n);
+            pending_ += n;
+            p += n;
+            bytes -= n;
+            if (pending_ < kBlockSize) {
+                return;
+            }
+            ProcessBlock(block_);
+            pending_ = 0;
+        }
+        for (; bytes >= kBlockSize; p += kBlockSize, bytes -= kBlockSize) {
+            ProcessBlock(p);
+        }
+        if (bytes != 0) {
+            std::memcpy(block_, p, bytes);
+        }
+        pending_ = bytes;
+    }
+
+    uint64_t Finish() const noexcept {
+        unsigned char tail[kBlockSize] = {};
+        std::memcpy(tail, block_, pending_);
+        uint64_t lanes[kLanes];
+        std::memcpy(lanes, lanes_, sizeof(lanes));
+        Mix(lanes, tail);
+        uint64_t h = (blocks_ * kBlockSize + pending_) * kPrime;
+        for (uint64_t lane : lanes) {
+            h = (h ^ (lane >> 29)) * kPrime;
+            h = (h << 31) | (h >> 33);
+        }
+        return h ^ (h >> 32);
+    }
+
+private:
+    static constexpr size_t kLanes = 4;
+    static constexpr size_t kBlockSize = kLanes * sizeof(uint64_t);
+    static constexpr uint64_t kPrime = 0x9E3779B185EBCA87;
+
+    static void Mix(uint64_t (&lanes)[kLanes], const unsigned char* block) noexcept {
+        for (size_t i = 0; i < kLanes; ++i) {
+            uint64_t word;
+            std::memcpy(&word, block + i * sizeof(uint64_t), sizeof(word));
+            lanes[i] = (lanes[i] ^ word) * kPrime;
+            lanes[i] = (lanes[i] << 27) | (lanes[i] >> 37);
+        }
+    }
+
+    void ProcessBlock(const unsigned char* block) noexcept {
+        Mix(lanes_, block);
+        ++blocks_;
+    }
+
+    uint64_t lanes_[kLanes] = { 1, 2, 3, 4 };
+    uint64_t blocks_ = 0;
+    unsigned char block_[kBlockSize] = {};
+    size_t pending_ = 0;
+};
+
+template <typename T>
+VectorIoHeader MakeVectorIoHeader(const T* data, size_t size, const VectorIoOptions& options) noexcept {
+    VectorIoHeader header;
+    header.element_size = sizeof(T);
+    header.size = size;
+    if (options.checksum) {
+        VectorChecksum checksum;
+        checksum.Update(data, size * sizeof(T));
+        header.checksum = checksum.Finish();
+        header.flags |= VectorIoHeader::kHasChecksum;
+    }
+    return header;
+}
+
+}  // namespace detail
+
+// Чтение вектора из потока байт, поступающего порциями (например, из неблокирующего сокета).
+// Prepare() возвращает область, куда следует положить очередные байты: сначала это заголовок,
+// затем хвост самого вектора, растущего через ResizeUninitialized по мере поступления данных,
+// а Commit(n) сообщает, сколько байт туда записано. Поэтому payload попадает в вектор без
+// промежуточного буфера. Заголовок проверяется, как только получен целиком; объём памяти
+// растёт вместе с полученными данными, а не по размеру из заголовка. Содержимое целевого
+// вектора заменяется; после исключения оно не определено
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+class VectorStreamReader {
+    static_assert(std::is_trivially_copyable_v<T>, "Binary I/O requires a trivially copyable T");
+
+    using Target = VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>;
+
+public:
+    explicit VectorStreamReader(Target& target)
+        : target_(target) {
+        target_.Clear();
+    }
+
+    // Получен ли вектор целиком
+    bool Done() const noexcept {
+        return header_received_ == sizeof(header_) && payload_received_ == PayloadBytes();
+    }
+
+    // Число байт, которые ещё нужно получить (до получения заголовка известно лишь его оставшееся число)
+    size_t Remaining() const noexcept {
+        return header_received_ < sizeof(header_) ? sizeof(header_) - header_received_
+                                                  : PayloadBytes() - payload_received_;
+    }
+
+    // Область для следующих байт потока. Пуста только после завершения чтения
+    VectorView<unsigned char> Prepare() {
+        if (header_received_ < sizeof(header_)) {
+            return VectorView<unsigned char>(reinterpret_cast<unsigned char*>(&header_) + header_received_,
+                                             sizeof(header_) - header_received_);
+        }
+        if (payload_received_ == target_.Size() * sizeof(T) && target_.Size() < size_) {
+            const size_t chunk = std::max(kMinChunkElements, target_.Size());
+            target_.ResizeUninitialized(target_.Size() + std::min(chunk, size_ - target_.Size()));
+        }
+        return VectorView<unsigned char>(PayloadBegin() + payload_received_,
+                                         target_.Size() * sizeof(T) - payload_received_);
+    }
+
+    // Отмечает, что в область, возвращённую Prepare(), записано bytes байт
+    void Commit(size_t bytes) {
+        if (header_received_ < sizeof(header_)) {
+            assert(bytes <= sizeof(header_) - header_received_);
+            header_received_ += bytes;
+            if (header_received_ == sizeof(header_)) {
+                ValidateHeader();
+            }
+        }
+        else {
+            assert(bytes <= target_.Size() * sizeof(T) - payload_received_);
+            checksum_.Update(PayloadBegin() + payload_received_, bytes);
+            payload_received_ += bytes;
+        }
+        if (Done()) {
+            ValidateChecksum();
+        }
+    }
+
+    // Копирует в вектор байты из data, пока он не прочитан целиком. Возвращает число принятых байт:
+    // байты после конца вектора остаются вызывающему
+    size_t Feed(const void* data, size_t bytes) {
+        auto* p = static_cast<const unsigned char*>(data);
+        size_t consumed = 0;
+        while (consumed < bytes && !Done()) {
+            const VectorView<unsigned char> buffer = Prepare();
+            const size_t n = std::min(buffer.Size(), bytes - consumed);
+            std::memcpy(buffer.Data(), p + consumed, n);
+            Commit(n);
+            consumed += n;
+        }
+        return consumed;
+    }
+
+private:
+    // Первая порция payload; дальше каждая порция равна уже полученному объёму
+    static constexpr size_t kMinChunkElements = std::max<size_t>(1, (size_t{ 64 } << 10) / sizeof(T));
+
+    size_t PayloadBytes() const noexcept {
+        return size_ * sizeof(T);
+    }
+
+    unsigned char* PayloadBegin() noexcept {
+        return reinterpret_cast<unsigned char*>(target_.View().Data());
+    }
+
+    void ValidateHeader() {
+        if (header_.magic != VectorIoHeader::kMagic) {
+            throw std::runtime_error("VectorStreamReader: not a vector stream");
+        }
+        if (header_.endian_mark != VectorIoHeader::kEndianMark) {
+            throw std::runtime_error("VectorStreamReader: stream was written with a different byte order");
+        }
+        if (header_.version != VectorIoHeader::kVersion) {
+            throw std::runtime_error("VectorStreamReader: unsupported stream version");
+        }
+        if (header_.element_size != sizeof(T)) {
+            throw std::runtime_error("VectorStreamReader: stream does not match element type");
+        }
+        if (header_.size > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::runtime_error("VectorStreamReader: stream size is too large");
+        }
+        size_ = static_cast<size_t>(header_.size);
+    }
+
+    void ValidateChecksum() const {
+        if ((header_.flags & VectorIoHeader::kHasChecksum) != 0 && checksum_.Finish() != header_.checksum) {
+            throw std::runtime_error("VectorStreamReader: checksum mismatch");
+        }
+    }
+
+    Target& target_;
+    VectorIoHeader header_;
+    size_t header_received_ = 0;
+    size_t size_ = 0;
+    size_t payload_received_ = 0;
+    detail::VectorChecksum checksum_;
+};
+
+// Записывает заголовок и элементы в поток двумя вызовами write, без поэлементного вывода
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+void WriteTo(std::ostream& out, const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& vector,
+             const VectorIoOptions& options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "Binary I/O requires a trivially copyable T");
+    const VectorIoHeader header = detail::MakeVectorIoHeader(vector.View().Data(), vector.Size(), options);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(vector.View().Data()), static_cast<std::streamsize>(vector.Size() * sizeof(T)));
+    if (!out) {
+        throw std::runtime_error("WriteTo: stream write failed");
+    }
+}
+
+// Читает вектор, записанный WriteTo. При ошибке вектор остаётся пустым
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+void ReadFrom(std::istream& in, VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& vector) {
+    try {
+        VectorStreamReader reader(vector);
+        while (!reader.Done()) {
+            const VectorView<unsigned char> buffer = reader.Prepare();
+            in.read(reinterpret_cast<char*>(buffer.Data()), static_cast<std::streamsize>(buffer.Size()));
+            if (in.gcount() == 0) {
+                throw std::runtime_error("ReadFrom: unexpected end of stream");
+            }
+            reader.Commit(static_cast<size_t>(in.gcount()));
+        }
+    }
+    catch (...) {
+        vector.Clear();
+        throw;
+    }
+}
+
+#if defined(VECTOR_IO_HAS_FD)
+
+// Записывает заголовок и элементы одним writev, досылая остаток при частичной записи
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+void WriteTo(int fd, const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& vector,
+             const VectorIoOptions& options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "Binary I/O requires a trivially copyable T");
+    const VectorIoHeader header = detail::MakeVectorIoHeader(vector.View().Data(), vector.Size(), options);
+    iovec parts[2] = {
+        { const_cast<VectorIoHeader*>(&header), sizeof(header) },
+        { const_cast<T*>(vector.View().Data()), vector.Size() * sizeof(T) },
+    };
+    iovec* part = parts;
+    int count = parts[1].iov_len != 0 ? 2 : 1;
+    while (count > 0) {
+        const ssize_t written = ::writev(fd, part, count);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= part->iov_len) {
+            left -= part->iov_len;
+            ++part;
+            --count;
+        }
+        if (count > 0) {
+            part->iov_base = static_cast<char*>(part->iov_base) + left;
+            part->iov_len -= left;
+        }
+    }
+}
+
+// Читает вектор, записанный WriteTo, порциями прямо в память вектора. При ошибке вектор остаётся пустым
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+void ReadFrom(int fd, VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& vector) {
+    try {
+        VectorStreamReader reader(vector);
+        while (!reader.Done()) {
+            const VectorView<unsigned char> buffer = reader.Prepare();
+            const ssize_t bytes = ::read(fd, buffer.Data(), buffer.Size());
+            if (bytes == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if (bytes == 0) {
+                throw std::runtime_error("ReadFrom: unexpected end of file");
+            }
+            reader.Commit(static_cast<size_t>(bytes));
+        }
+    }
+    catch (...) {
+        vector.Clear();
+        throw;
+    }
+}
+
+#endif
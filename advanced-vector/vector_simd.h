@@ -0,0 +1,576 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Векторизованные алгоритмы над непрерывными массивами Vector (и любыми диапазонами указателей).
+// Для float и int32_t набор инструкций (SSE4.2, AVX2, AVX-512, NEON) выбирается во время выполнения,
+// для остальных типов и процессоров используется скалярная версия.
+// Сумма вычисляется в другом порядке, чем при последовательном сложении, поэтому для float
+// результат может отличаться в последних битах; сумма целых берётся по модулю 2^32.
+// Результат Min/Max для массивов, содержащих NaN, не определён
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define VECTOR_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__GNUC__)
+#define VECTOR_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+
+enum class SimdLevel {
+    kScalar,
+    kSse42,
+    kAvx2,
+    kAvx512,
+    kNeon,
+};
+
+// Наилучший набор инструкций, поддерживаемый процессором
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(VECTOR_SIMD_X86)
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::kAvx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::kAvx2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SimdLevel::kSse42;
+        }
+        return SimdLevel::kScalar;
+    }();
+    return level;
+#elif defined(VECTOR_SIMD_NEON)
+    return SimdLevel::kNeon;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+inline bool IsSimdLevelSupported(SimdLevel level) noexcept {
+    const SimdLevel detected = DetectSimdLevel();
+    if (level == SimdLevel::kScalar || level == detected) {
+        return true;
+    }
+    return detected != SimdLevel::kNeon && level != SimdLevel::kNeon && level < detected;
+}
+
+namespace detail {
+
+inline std::atomic<SimdLevel>& ActiveLevel() noexcept {
+    static std::atomic<SimdLevel> level{ DetectSimdLevel() };
+    return level;
+}
+
+inline unsigned PopCount(unsigned mask) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#else
+    unsigned count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned CountTrailingZeros(unsigned mask) noexcept {
+    assert(mask != 0);
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned count = 0;
+    for (; (mask & 1) == 0; mask >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Скалярные операции. Целые складываются и умножаются без знака, чтобы переполнение
+// давало тот же результат, что и векторные инструкции
+template <typename T>
+struct ScalarTraits {
+    using Reg = T;
+    static constexpr size_t kLanes = 1;
+
+    static Reg Load(const T* p) noexcept {
+        return *p;
+    }
+    static void Store(T* p, Reg r) noexcept {
+        *p = r;
+    }
+    static Reg Set1(T value) noexcept {
+        return value;
+    }
+    static Reg Add(Reg a, Reg b) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            using U = std::make_unsigned_t<T>;
+            return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+        }
+        else {
+            return a + b;
+        }
+    }
+    static Reg MulAdd(Reg x, Reg a, Reg b) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            using U = std::make_unsigned_t<T>;
+            return static_cast<T>(static_cast<U>(x) * static_cast<U>(a) + static_cast<U>(b));
+        }
+        else {
+            return x * a + b;
+        }
+    }
+    static Reg Min(Reg a, Reg b) noexcept {
+        return b < a ? b : a;
+    }
+    static Reg Max(Reg a, Reg b) noexcept {
+        return a < b ? b : a;
+    }
+    static unsigned EqMask(Reg a, Reg b) noexcept {
+        return a == b ? 1u : 0u;
+    }
+};
+
+#if defined(VECTOR_SIMD_X86)
+
+#define VECTOR_SIMD_FN(isa) __attribute__((target(isa), always_inline)) static inline
+
+struct Sse42Float {
+    using Reg = __m128;
+    static constexpr size_t kLanes = 4;
+    VECTOR_SIMD_FN("sse4.2") Reg Load(const float* p) { return _mm_loadu_ps(p); }
+    VECTOR_SIMD_FN("sse4.2") void Store(float* p, Reg r) { _mm_storeu_ps(p, r); }
+    VECTOR_SIMD_FN("sse4.2") Reg Set1(float v) { return _mm_set1_ps(v); }
+    VECTOR_SIMD_FN("sse4.2") Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    VECTOR_SIMD_FN("sse4.2") Reg MulAdd(Reg x, Reg a, Reg b) { return _mm_add_ps(_mm_mul_ps(x, a), b); }
+    VECTOR_SIMD_FN("sse4.2") Reg Min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+    VECTOR_SIMD_FN("sse4.2") Reg Max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+    VECTOR_SIMD_FN("sse4.2") unsigned EqMask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(a, b)));
+    }
+};
+
+struct Sse42Int32 {
+    using Reg = __m128i;
+    static constexpr size_t kLanes = 4;
+    VECTOR_SIMD_FN("sse4.2") Reg Load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const Reg*>(p)); }
+    VECTOR_SIMD_FN("sse4.2") void Store(int32_t* p, Reg r) { _mm_storeu_si128(reinterpret_cast<Reg*>(p), r); }
+    VECTOR_SIMD_FN("sse4.2") Reg Set1(int32_t v) { return _mm_set1_epi32(v); }
+    VECTOR_SIMD_FN("sse4.2") Reg Add(Reg a, Reg b) { return _mm_add_epi32(a, b); }
+    VECTOR_SIMD_FN("sse4.2") Reg MulAdd(Reg x, Reg a, Reg b) { return _mm_add_epi32(_mm_mullo_epi32(x, a), b); }
+    VECTOR_SIMD_FN("sse4.2") Reg Min(Reg a, Reg b) { return _mm_min_epi32(a, b); }
+    VECTOR_SIMD_FN("sse4.2") Reg Max(Reg a, Reg b) { return _mm_max_epi32(a, b); }
+    VECTOR_SIMD_FN("sse4.2") unsigned EqMask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))));
+    }
+};
+
+struct Avx2Float {
+    using Reg = __m256;
+    static constexpr size_t kLanes = 8;
+    VECTOR_SIMD_FN("avx2") Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+    VECTOR_SIMD_FN("avx2") void Store(float* p, Reg r) { _mm256_storeu_ps(p, r); }
+    VECTOR_SIMD_FN("avx2") Reg Set1(float v) { return _mm256_set1_ps(v); }
+    VECTOR_SIMD_FN("avx2") Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    VECTOR_SIMD_FN("avx2") Reg MulAdd(Reg x, Reg a, Reg b) { return _mm256_add_ps(_mm256_mul_ps(x, a), b); }
+    VECTOR_SIMD_FN("avx2") Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+    VECTOR_SIMD_FN("avx2") Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+    VECTOR_SIMD_FN("avx2") unsigned EqMask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+    }
+};
+
+struct Avx2Int32 {
+    using Reg = __m256i;
+    static constexpr size_t kLanes = 8;
+    VECTOR_SIMD_FN("avx2") Reg Load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const Reg*>(p)); }
+    VECTOR_SIMD_FN("avx2") void Store(int32_t* p, Reg r) { _mm256_storeu_si256(reinterpret_cast<Reg*>(p), r); }
+    VECTOR_SIMD_FN("avx2") Reg Set1(int32_t v) { return _mm256_set1_epi32(v); }
+    VECTOR_SIMD_FN("avx2") Reg Add(Reg a, Reg b) { return _mm256_add_epi32(a, b); }
+    VECTOR_SIMD_FN("avx2") Reg MulAdd(Reg x, Reg a, Reg b) { return _mm256_add_epi32(_mm256_mullo_epi32(x, a), b); }
+    VECTOR_SIMD_FN("avx2") Reg Min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+    VECTOR_SIMD_FN("avx2") Reg Max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+    VECTOR_SIMD_FN("avx2") unsigned EqMask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))));
+    }
+};
+
+struct Avx512Float {
+    using Reg = __m512;
+    static constexpr size_t kLanes = 16;
+    VECTOR_SIMD_FN("avx512f") Reg Load(const float* p) { return _mm512_loadu_ps(p); }
+    VECTOR_SIMD_FN("avx512f") void Store(float* p, Reg r) { _mm512_storeu_ps(p, r); }
+    VECTOR_SIMD_FN("avx512f") Reg Set1(float v) { return _mm512_set1_ps(v); }
+    VECTOR_SIMD_FN("avx512f") Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+    VECTOR_SIMD_FN("avx512f") Reg MulAdd(Reg x, Reg a, Reg b) { return _mm512_add_ps(_mm512_mul_ps(x, a), b); }
+    VECTOR_SIMD_FN("avx512f") Reg Min(Reg a, Reg b) { return _mm512_min_ps(a, b); }
+    VECTOR_SIMD_FN("avx512f") Reg Max(Reg a, Reg b) { return _mm512_max_ps(a, b); }
+    VECTOR_SIMD_FN("avx512f") unsigned EqMask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ));
+    }
+};
+
+struct Avx512Int32 {
+    using Reg = __m512i;
+    static constexpr size_t kLanes = 16;
+    VECTOR_SIMD_FN("avx512f") Reg Load(const int32_t* p) { return _mm512_loadu_si512(p); }
+    VECTOR_SIMD_FN("avx512f") void Store(int32_t* p, Reg r) { _mm512_storeu_si512(p, r); }
+    VECTOR_SIMD_FN("avx512f") Reg Set1(int32_t v) { return _mm512_set1_epi32(v); }
+    VECTOR_SIMD_FN("avx512f") Reg Add(Reg a, Reg b) { return _mm512_add_epi32(a, b); }
+    VECTOR_SIMD_FN("avx512f") Reg MulAdd(Reg x, Reg a, Reg b) { return _mm512_add_epi32(_mm512_mullo_epi32(x, a), b); }
+    VECTOR_SIMD_FN("avx512f") Reg Min(Reg a, Reg b) { return _mm512_min_epi32(a, b); }
+    VECTOR_SIMD_FN("avx512f") Reg Max(Reg a, Reg b) { return _mm512_max_epi32(a, b); }
+    VECTOR_SIMD_FN("avx512f") unsigned EqMask(Reg a, Reg b) {
+        return static_cast<unsigned>(_mm512_cmpeq_epi32_mask(a, b));
+    }
+};
+
+#undef VECTOR_SIMD_FN
+
+// GCC ошибочно предупреждает о неинициализированных значениях внутри _mm512_undefined_*
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#define VECTOR_SIMD_RESTORE_DIAGNOSTICS 1
+#endif
+
+#define VECTOR_SIMD_KERNEL_ATTR_SSE42 __attribute__((target("sse4.2")))
+#define VECTOR_SIMD_KERNEL_ATTR_AVX2 __attribute__((target("avx2")))
+#define VECTOR_SIMD_KERNEL_ATTR_AVX512 __attribute__((target("avx512f")))
+
+#elif defined(VECTOR_SIMD_NEON)
+
+#define VECTOR_SIMD_FN __attribute__((always_inline)) static inline
+
+struct NeonFloat {
+    using Reg = float32x4_t;
+    static constexpr size_t kLanes = 4;
+    VECTOR_SIMD_FN Reg Load(const float* p) { return vld1q_f32(p); }
+    VECTOR_SIMD_FN void Store(float* p, Reg r) { vst1q_f32(p, r); }
+    VECTOR_SIMD_FN Reg Set1(float v) { return vdupq_n_f32(v); }
+    VECTOR_SIMD_FN Reg Add(Reg a, Reg b) { return vaddq_f32(a, b); }
+    VECTOR_SIMD_FN Reg MulAdd(Reg x, Reg a, Reg b) { return vaddq_f32(vmulq_f32(x, a), b); }
+    VECTOR_SIMD_FN Reg Min(Reg a, Reg b) { return vminq_f32(a, b); }
+    VECTOR_SIMD_FN Reg Max(Reg a, Reg b) { return vmaxq_f32(a, b); }
+    VECTOR_SIMD_FN unsigned EqMask(Reg a, Reg b) {
+        static const uint32_t kBits[4] = { 1, 2, 4, 8 };
+        return vaddvq_u32(vandq_u32(vceqq_f32(a, b), vld1q_u32(kBits)));
+    }
+};
+
+struct NeonInt32 {
+    using Reg = int32x4_t;
+    static constexpr size_t kLanes = 4;
+    VECTOR_SIMD_FN Reg Load(const int32_t* p) { return vld1q_s32(p); }
+    VECTOR_SIMD_FN void Store(int32_t* p, Reg r) { vst1q_s32(p, r); }
+    VECTOR_SIMD_FN Reg Set1(int32_t v) { return vdupq_n_s32(v); }
+    VECTOR_SIMD_FN Reg Add(Reg a, Reg b) { return vaddq_s32(a, b); }
+    VECTOR_SIMD_FN Reg MulAdd(Reg x, Reg a, Reg b) { return vmlaq_s32(b, x, a); }
+    VECTOR_SIMD_FN Reg Min(Reg a, Reg b) { return vminq_s32(a, b); }
+    VECTOR_SIMD_FN Reg Max(Reg a, Reg b) { return vmaxq_s32(a, b); }
+    VECTOR_SIMD_FN unsigned EqMask(Reg a, Reg b) {
+        static const uint32_t kBits[4] = { 1, 2, 4, 8 };
+        return vaddvq_u32(vandq_u32(vceqq_s32(a, b), vld1q_u32(kBits)));
+    }
+};
+
+#undef VECTOR_SIMD_FN
+
+#endif
+
+// Ядра алгоритмов, общие для всех наборов инструкций. Компилятор требует, чтобы функции,
+// использующие инструкции AVX2/AVX-512, сами были помечены соответствующим target,
+// поэтому ядра объявляются макросом отдельно для каждого набора
+#define VECTOR_SIMD_DEFINE_KERNELS(Name, ATTR)                                                 \
+    struct Name {                                                                             \
+        template <typename Traits, typename T>                                                \
+        ATTR static size_t Find(const T* data, size_t n, T value) {                           \
+            const auto needle = Traits::Set1(value);                                          \
+            size_t i = 0;                                                                      \
+            for (; i + Traits::kLanes <= n; i += Traits::kLanes) {                            \
+                const unsigned mask = Traits::EqMask(Traits::Load(data + i), needle);         \
+                if (mask != 0) {                                                              \
+                    return i + CountTrailingZeros(mask);                                      \
+                }                                                                             \
+            }                                                                                  \
+            for (; i < n && !(data[i] == value); ++i) {                                       \
+            }                                                                                  \
+            return i;                                                                          \
+        }                                                                                      \
+                                                                                               \
+        template <typename Traits, typename T>                                                \
+        ATTR static size_t Count(const T* data, size_t n, T value) {                          \
+            const auto needle = Traits::Set1(value);                                          \
+            size_t count = 0;                                                                  \
+            size_t i = 0;                                                                      \
+            for (; i + Traits::kLanes <= n; i += Traits::kLanes) {                            \
+                count += PopCount(Traits::EqMask(Traits::Load(data + i), needle));            \
+            }                                                                                  \
+            for (; i < n; ++i) {                                                              \
+                count += data[i] == value ? 1 : 0;                                            \
+            }                                                                                  \
+            return count;                                                                      \
+        }                                                                                      \
+                                                                                               \
+        template <typename Traits, typename T>                                                \
+        ATTR static T Sum(const T* data, size_t n) {                                          \
+            auto acc0 = Traits::Set1(T{});                                                    \
+            auto acc1 = acc0;                                                                  \
+            size_t i = 0;                                                                      \
+            for (; i + 2 * Traits::kLanes <= n; i += 2 * Traits::kLanes) {                    \
+                acc0 = Traits::Add(acc0, Traits::Load(data + i));                             \
+                acc1 = Traits::Add(acc1, Traits::Load(data + i + Traits::kLanes));            \
+            }                                                                                  \
+            T lanes[Traits::kLanes];                                                           \
+            Traits::Store(lanes, Traits::Add(acc0, acc1));                                    \
+            T result = lanes[0];                                                               \
+            for (size_t lane = 1; lane < Traits::kLanes; ++lane) {                            \
+                result = ScalarTraits<T>::Add(result, lanes[lane]);                           \
+            }                                                                                  \
+            for (; i < n; ++i) {                                                              \
+                result = ScalarTraits<T>::Add(result, data[i]);                               \
+            }                                                                                  \
+            return result;                                                                     \
+        }                                                                                      \
+                                                                                               \
+        template <typename Traits, bool IsMin, typename T>                                    \
+        ATTR static T MinMax(const T* data, size_t n) {                                       \
+            assert(n > 0);                                                                     \
+            T result = data[0];                                                                \
+            size_t i = 0;                                                                      \
+            if (n >= Traits::kLanes) {                                                        \
+                auto acc = Traits::Load(data);                                                 \
+                for (i = Traits::kLanes; i + Traits::kLanes <= n; i += Traits::kLanes) {      \
+                    const auto block = Traits::Load(data + i);                                \
+                    acc = IsMin ? Traits::Min(acc, block) : Traits::Max(acc, block);          \
+                }                                                                              \
+                T lanes[Traits::kLanes];                                                       \
+                Traits::Store(lanes, acc);                                                     \
+                result = lanes[0];                                                             \
+                for (size_t lane = 1; lane < Traits::kLanes; ++lane) {                        \
+                    result = IsMin ? ScalarTraits<T>::Min(result, lanes[lane])                \
+                                   : ScalarTraits<T>::Max(result, lanes[lane]);               \
+                }                                                                              \
+            }                                                                                  \
+            for (; i < n; ++i) {                                                              \
+                result = IsMin ? ScalarTraits<T>::Min(result, data[i])                        \
+                               : ScalarTraits<T>::Max(result, data[i]);                       \
+            }                                                                                  \
+            return result;                                                                     \
+        }                                                                                      \
+                                                                                               \
+        template <typename Traits, typename T>                                                \
+        ATTR static void Fill(T* data, size_t n, T value) {                                   \
+            const auto block = Traits::Set1(value);                                           \
+            size_t i = 0;                                                                      \
+            for (; i + Traits::kLanes <= n; i += Traits::kLanes) {                            \
+                Traits::Store(data + i, block);                                               \
+            }                                                                                  \
+            for (; i < n; ++i) {                                                              \
+                data[i] = value;                                                               \
+            }                                                                                  \
+        }                                                                                      \
+                                                                                               \
+        template <typename Traits, typename T>                                                \
+        ATTR static void MulAdd(const T* src, size_t n, T* dest, T scale, T offset) {         \
+            const auto a = Traits::Set1(scale);                                               \
+            const auto b = Traits::Set1(offset);                                              \
+            size_t i = 0;                                                                      \
+            for (; i + Traits::kLanes <= n; i += Traits::kLanes) {                            \
+                Traits::Store(dest + i, Traits::MulAdd(Traits::Load(src + i), a, b));         \
+            }                                                                                  \
+            for (; i < n; ++i) {                                                              \
+                dest[i] = ScalarTraits<T>::MulAdd(src[i], scale, offset);                     \
+            }                                                                                  \
+        }                                                                                      \
+                                                                                               \
+        /* Произвольное преобразование компилируется под набор инструкций ядра, */            \
+        /* чтобы компилятор мог векторизовать цикл с его помощью */                          \
+        template <typename T, typename U, typename Op>                                        \
+        ATTR static void Transform(const T* src, size_t n, U* dest, Op& op) {                 \
+            for (size_t i = 0; i < n; ++i) {                                                  \
+                dest[i] = op(src[i]);                                                          \
+            }                                                                                  \
+        }                                                                                      \
+    }
+
+VECTOR_SIMD_DEFINE_KERNELS(ScalarKernels, );
+#if defined(VECTOR_SIMD_X86)
+VECTOR_SIMD_DEFINE_KERNELS(Sse42Kernels, VECTOR_SIMD_KERNEL_ATTR_SSE42);
+VECTOR_SIMD_DEFINE_KERNELS(Avx2Kernels, VECTOR_SIMD_KERNEL_ATTR_AVX2);
+VECTOR_SIMD_DEFINE_KERNELS(Avx512Kernels, VECTOR_SIMD_KERNEL_ATTR_AVX512);
+#undef VECTOR_SIMD_KERNEL_ATTR_SSE42
+#undef VECTOR_SIMD_KERNEL_ATTR_AVX2
+#undef VECTOR_SIMD_KERNEL_ATTR_AVX512
+#elif defined(VECTOR_SIMD_NEON)
+VECTOR_SIMD_DEFINE_KERNELS(NeonKernels, );
+#endif
+
+#undef VECTOR_SIMD_DEFINE_KERNELS
+
+// Не даёт выводить T из аргумента-значения, чтобы Find(v, 0) работал и для Vector<float>
+template <typename T>
+struct NonDeduced {
+    using type = T;
+};
+template <typename T>
+using NonDeducedT = typename NonDeduced<T>::type;
+
+template <typename T>
+inline constexpr bool kHasSimdKernels = std::is_same_v<T, float> || std::is_same_v<T, int32_t>;
+
+// Вызывает call(kernels, traits) с ядрами и операциями для активного набора инструкций
+template <typename T, typename Call>
+decltype(auto) Dispatch(Call&& call) {
+    if constexpr (kHasSimdKernels<T>) {
+        constexpr bool kIsFloat = std::is_same_v<T, float>;
+        switch (ActiveLevel().load(std::memory_order_relaxed)) {
+#if defined(VECTOR_SIMD_X86)
+            case SimdLevel::kAvx512:
+                return call(Avx512Kernels{}, std::conditional_t<kIsFloat, Avx512Float, Avx512Int32>{});
+            case SimdLevel::kAvx2:
+                return call(Avx2Kernels{}, std::conditional_t<kIsFloat, Avx2Float, Avx2Int32>{});
+            case SimdLevel::kSse42:
+                return call(Sse42Kernels{}, std::conditional_t<kIsFloat, Sse42Float, Sse42Int32>{});
+#elif defined(VECTOR_SIMD_NEON)
+            case SimdLevel::kNeon:
+                return call(NeonKernels{}, std::conditional_t<kIsFloat, NeonFloat, NeonInt32>{});
+#endif
+            default:
+                break;
+        }
+    }
+    return call(ScalarKernels{}, ScalarTraits<T>{});
+}
+
+}  // namespace detail
+
+// Переключает набор инструкций (например, для сравнения версий). Возвращает false,
+// если процессор его не поддерживает
+inline bool SetSimdLevel(SimdLevel level) noexcept {
+    if (!IsSimdLevelSupported(level)) {
+        return false;
+    }
+    detail::ActiveLevel().store(level, std::memory_order_relaxed);
+    return true;
+}
+
+inline SimdLevel GetSimdLevel() noexcept {
+    return detail::ActiveLevel().load(std::memory_order_relaxed);
+}
+
+// Возвращает указатель на первый элемент, равный value, или last
+template <typename T>
+const T* Find(const T* first, const T* last, detail::NonDeducedT<T> value) {
+    const size_t n = last - first;
+    return first + detail::Dispatch<T>([&](auto kernels, auto traits) {
+        return kernels.template Find<decltype(traits)>(first, n, value);
+    });
+}
+
+template <typename T>
+size_t Count(const T* first, const T* last, detail::NonDeducedT<T> value) {
+    const size_t n = last - first;
+    return detail::Dispatch<T>([&](auto kernels, auto traits) {
+        return kernels.template Count<decltype(traits)>(first, n, value);
+    });
+}
+
+template <typename T>
+T Sum(const T* first, const T* last) {
+    const size_t n = last - first;
+    return detail::Dispatch<T>([&](auto kernels, auto traits) {
+        return kernels.template Sum<decltype(traits)>(first, n);
+    });
+}
+
+// Минимум непустого диапазона
+template <typename T>
+T Min(const T* first, const T* last) {
+    assert(first != last);
+    const size_t n = last - first;
+    return detail::Dispatch<T>([&](auto kernels, auto traits) {
+        return kernels.template MinMax<decltype(traits), true>(first, n);
+    });
+}
+
+// Максимум непустого диапазона
+template <typename T>
+T Max(const T* first, const T* last) {
+    assert(first != last);
+    const size_t n = last - first;
+    return detail::Dispatch<T>([&](auto kernels, auto traits) {
+        return kernels.template MinMax<decltype(traits), false>(first, n);
+    });
+}
+
+template <typename T>
+void Fill(T* first, T* last, detail::NonDeducedT<T> value) {
+    const size_t n = last - first;
+    detail::Dispatch<T>([&](auto kernels, auto traits) {
+        kernels.template Fill<decltype(traits)>(first, n, value);
+    });
+}
+
+// dest[i] = first[i] * scale + offset. Диапазоны могут совпадать
+template <typename T>
+void MulAdd(const T* first, const T* last, T* dest, detail::NonDeducedT<T> scale, detail::NonDeducedT<T> offset) {
+    const size_t n = last - first;
+    detail::Dispatch<T>([&](auto kernels, auto traits) {
+        kernels.template MulAdd<decltype(traits)>(first, n, dest, scale, offset);
+    });
+}
+
+// dest[i] = op(first[i]). Цикл компилируется под активный набор инструкций
+template <typename T, typename U, typename Op>
+void Transform(const T* first, const T* last, U* dest, Op op) {
+    const size_t n = last - first;
+    detail::Dispatch<T>([&](auto kernels, auto) {
+        kernels.Transform(first, n, dest, op);
+    });
+}
+
+// Перегрузки для векторов: алгоритмы работают с их непрерывным буфером
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+const T* Find(const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& v, detail::NonDeducedT<T> value) {
+    return Find(v.View().begin(), v.View().end(), value);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+size_t Count(const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& v, detail::NonDeducedT<T> value) {
+    return Count(v.View().begin(), v.View().end(), value);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+T Sum(const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& v) {
+    return Sum(v.View().begin(), v.View().end());
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+T Min(const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& v) {
+    return Min(v.View().begin(), v.View().end());
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+T Max(const VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& v) {
+    return Max(v.View().begin(), v.View().end());
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename StatsPolicy, typename CheckPolicy>
+void Fill(VectorBase<T, Storage, GrowthPolicy, StatsPolicy, CheckPolicy>& v, detail::NonDeducedT<T> value) {
+    Fill(v.View().begin(), v.View().end(), value);
+}
+
+}  // namespace simd
+
+#if defined(VECTOR_SIMD_RESTORE_DIAGNOSTICS)
+#pragma GCC diagnostic pop
+#undef VECTOR_SIMD_RESTORE_DIAGNOSTICS
+#endif